@@ -95,12 +95,18 @@ void FBrettPlugin::ShutdownModule()
 	}
 }
 
-void RefreshCollisionChange(const UStaticMesh * StaticMesh)
+// Refreshes the physics of every component using one of StaticMeshes, in a
+// single pass over the components.
+void RefreshCollisionChange(const TSet<const UStaticMesh*>& StaticMeshes)
 {
+	if (StaticMeshes.Num() == 0) {
+		return;
+	}
+
 	for (FObjectIterator Iter(UStaticMeshComponent::StaticClass()); Iter; ++Iter)
 	{
 		UStaticMeshComponent* StaticMeshComponent = Cast<UStaticMeshComponent>(*Iter);
-		if (StaticMeshComponent->StaticMesh == StaticMesh)
+		if (StaticMeshes.Contains(StaticMeshComponent->StaticMesh))
 		{
 			// it needs to recreate IF it already has been created
 			if (StaticMeshComponent->IsPhysicsStateCreated())
@@ -174,18 +180,176 @@ T* GetExistingAsset(const FString& PackageName, const FString& AssetName) {
 	return NULL;
 }
 
-UTexture* ImportTexture(const FString& PackageName, FString& AssetName, const FString& SourcePath)
+// Owns the parsed files an import needs for longer than one function, so they
+// can be released in bulk once the assets built from them are done. It also
+// remembers every asset built or found during the import, keyed by kind and
+// ROSE source path, so each one is only built or looked up once. Textures and
+// meshes are also keyed by a hash of their source file, as ROSE keeps many
+// byte-identical copies of them under different paths.
+struct ImportSession {
+	enum AssetKind {
+		TextureAsset,
+		MaterialAsset,
+		MaterialInstanceAsset,
+		MeshAsset,
+		BlueprintAsset,
+		AssetKindCount
+	};
+
+	ImportSession() {
+		FMemory::Memzero(assetHits, sizeof(assetHits));
+		FMemory::Memzero(assetMisses, sizeof(assetMisses));
+		FMemory::Memzero(contentHits, sizeof(contentHits));
+	}
+
+	~ImportSession() {
+		finishMaterials();
+		finishMeshes();
+	}
+
+	Zms& loadZms(const FString& Path, uint32 attributes) {
+		meshes.Add(new Zms(*Path, attributes));
+		return meshes.Last();
+	}
+
+	template<typename T>
+	T* findAsset(AssetKind kind, const FString& SourcePath) {
+		UObject** Found = assets[kind].Find(assetKey(SourcePath));
+		if (Found) {
+			assetHits[kind]++;
+			return Cast<T>(*Found);
+		}
+		assetMisses[kind]++;
+		return NULL;
+	}
+
+	void addAsset(AssetKind kind, const FString& SourcePath, UObject* Asset) {
+		if (Asset) {
+			assets[kind].Add(assetKey(SourcePath), Asset);
+		}
+	}
+
+	// Finds an asset built from a byte-identical source file. Whoever asked
+	// should record the asset under its own path with addAsset.
+	template<typename T>
+	T* findContent(AssetKind kind, const FString& ContentKey) {
+		if (ContentKey.IsEmpty()) {
+			return NULL;
+		}
+		UObject** Found = contentAssets[kind].Find(ContentKey);
+		if (Found) {
+			contentHits[kind]++;
+			return Cast<T>(*Found);
+		}
+		return NULL;
+	}
+
+	void addContent(AssetKind kind, const FString& ContentKey, UObject* Asset) {
+		if (Asset && !ContentKey.IsEmpty()) {
+			contentAssets[kind].Add(ContentKey, Asset);
+		}
+	}
+
+	void logAssetStats() const {
+		static const TCHAR* KindNames[AssetKindCount] = { TEXT("textures"), TEXT("materials"), TEXT("material instances"), TEXT("meshes"), TEXT("blueprints") };
+		for (int32 i = 0; i < AssetKindCount; ++i) {
+			UE_LOG(RosePlugin, Log, TEXT("Session %s: %d built or found, %d reused, %d shared with identical files"),
+				KindNames[i], assetMisses[i] - contentHits[i], assetHits[i], contentHits[i]);
+		}
+	}
+
+	// Materials are finished in one go instead of each re-registering every
+	// component in the editor as it is created.
+	void addNewMaterial(UMaterialInterface* Material) {
+		newMaterials.Add(Material);
+	}
+
+	// Re-registers components once if any of them already use one of the new
+	// materials. Freshly imported materials aren't used yet, so usually none do.
+	void finishMaterials() {
+		if (newMaterials.Num() == 0) {
+			return;
+		}
+
+		bool InUse = false;
+		TArray<UMaterialInterface*> UsedMaterials;
+		for (TObjectIterator<UPrimitiveComponent> It; It && !InUse; ++It) {
+			if (!It->IsRegistered()) {
+				continue;
+			}
+			UsedMaterials.Reset();
+			It->GetUsedMaterials(UsedMaterials);
+			for (int32 i = 0; i < UsedMaterials.Num() && !InUse; ++i) {
+				InUse = newMaterials.Contains(UsedMaterials[i]);
+			}
+		}
+
+		if (InUse) {
+			FGlobalComponentReregisterContext RecreateComponents;
+		}
+		UE_LOG(RosePlugin, Log, TEXT("Finished %d new materials, %s re-registering components"), newMaterials.Num(), InUse ? TEXT("after") : TEXT("without"));
+		newMaterials.Empty();
+	}
+
+	// Meshes whose collision was rebuilt, so the components using them can be
+	// refreshed together rather than after every mesh.
+	void addChangedMesh(const UStaticMesh* StaticMesh) {
+		changedMeshes.Add(StaticMesh);
+	}
+
+	void finishMeshes() {
+		RefreshCollisionChange(changedMeshes);
+		changedMeshes.Empty();
+	}
+
+	// Returns an empty key for an empty or unreadable file.
+	static FString contentKey(const uint8* Data, int32 Size) {
+		if (Data == NULL || Size <= 0) {
+			return FString();
+		}
+		FSHAHash Hash;
+		FSHA1::HashBuffer(Data, Size, Hash.Hash);
+		return Hash.ToString();
+	}
+
+	// Parsed files are released, but assets stay known for the whole import.
+	void reset() {
+		meshes.Empty();
+	}
+
+	TIndirectArray<Zms> meshes;
+
+private:
+	// FNames compare case-insensitively, so only the separators need fixing up.
+	static FName assetKey(const FString& SourcePath) {
+		FString Key = SourcePath;
+		FPaths::NormalizeFilename(Key);
+		return FName(*Key);
+	}
+
+	TMap<FName, UObject*> assets[AssetKindCount];
+	TMap<FString, UObject*> contentAssets[AssetKindCount];
+	int32 assetHits[AssetKindCount];
+	int32 assetMisses[AssetKindCount];
+	int32 contentHits[AssetKindCount];
+	TSet<UMaterialInterface*> newMaterials;
+	TSet<const UStaticMesh*> changedMeshes;
+};
+
+UTexture* ImportTexture(ImportSession& session, const FString& PackageName, FString& AssetName, const FString& SourcePath)
 {
+	UTexture* SessionTexture = session.findAsset<UTexture>(ImportSession::TextureAsset, SourcePath);
+	if (SessionTexture != NULL) {
+		AssetName = SessionTexture->GetName();
+		return SessionTexture;
+	}
+
 	UTexture* ExistingTexture = GetExistingAsset<UTexture>(PackageName, AssetName);
 	if (ExistingTexture != NULL) {
+		session.addAsset(ImportSession::TextureAsset, SourcePath, ExistingTexture);
 		return ExistingTexture;
 	}
 
-	UPackage* Package = GetOrMakePackage(PackageName, AssetName);
-	if (Package == NULL) {
-		return NULL;
-	}
-
 	TArray<uint8> DataBinary;
 	if (!FFileHelper::LoadFileToArray(DataBinary, *SourcePath)) {
 		UE_LOG(RosePlugin, Warning, TEXT("Unable to read texture from source."));
@@ -193,6 +357,19 @@ UTexture* ImportTexture(const FString& PackageName, FString& AssetName, const FS
 	}
 	const uint8* PtrTexture = DataBinary.GetTypedData();
 
+	FString ContentKey = ImportSession::contentKey(PtrTexture, DataBinary.Num());
+	UTexture* SameTexture = session.findContent<UTexture>(ImportSession::TextureAsset, ContentKey);
+	if (SameTexture != NULL) {
+		session.addAsset(ImportSession::TextureAsset, SourcePath, SameTexture);
+		AssetName = SameTexture->GetName();
+		return SameTexture;
+	}
+
+	UPackage* Package = GetOrMakePackage(PackageName, AssetName);
+	if (Package == NULL) {
+		return NULL;
+	}
+
 	UTextureFactory* TextureFact = new UTextureFactory(FPostConstructInitializeProperties());
 	TextureFact->AddToRoot();
 
@@ -212,10 +389,12 @@ UTexture* ImportTexture(const FString& PackageName, FString& AssetName, const FS
 
 	TextureFact->RemoveFromRoot();
 
+	session.addAsset(ImportSession::TextureAsset, SourcePath, Texture);
+	session.addContent(ImportSession::TextureAsset, ContentKey, Texture);
 	return Texture;
 }
 
-UMaterial* GetOrMakeBaseMaterial(const Zsc::Texture& MatInfo) {
+FString GetBaseMaterialName(const Zsc::Texture& MatInfo) {
 	FString MaterialName;
 	if (MatInfo.alphaTestEnabled) {
 		MaterialName = "AlphaRefMaterial";
@@ -228,11 +407,22 @@ UMaterial* GetOrMakeBaseMaterial(const Zsc::Texture& MatInfo) {
 	if (MatInfo.twoSided) {
 		MaterialName.Append("_DS");
 	}
+	return MaterialName;
+}
+
+UMaterial* GetOrMakeBaseMaterial(ImportSession& session, const Zsc::Texture& MatInfo) {
+	FString MaterialName = GetBaseMaterialName(MatInfo);
+
+	UMaterial* Material = session.findAsset<UMaterial>(ImportSession::MaterialAsset, MaterialName);
+	if (Material != NULL) {
+		return Material;
+	}
 
 	FString MaterialFullName = FString::Printf(TEXT("%s/%s.%s"), *RosePackageName, *MaterialName, *MaterialName);
-	UMaterial* Material = LoadObject<UMaterial>(NULL, *MaterialFullName, NULL, LOAD_None, NULL);
+	Material = LoadObject<UMaterial>(NULL, *MaterialFullName, NULL, LOAD_None, NULL);
 	if (Material != NULL) {
 		UE_LOG(RosePlugin, Log, TEXT("Skipped Base Creation - Found It!"));
+		session.addAsset(ImportSession::MaterialAsset, MaterialName, Material);
 		return Material;
 	}
 
@@ -254,9 +444,9 @@ UMaterial* GetOrMakeBaseMaterial(const Zsc::Texture& MatInfo) {
 	// Set the dirty flag so this package will get saved later
 	Material->MarkPackageDirty();
 
-	// make sure that any static meshes, etc using this material will stop using the FMaterialResource of the original 
-	// material, and will use the new FMaterialResource created when we make a new UMaterial in place
-	FGlobalComponentReregisterContext RecreateComponents;
+	// Any components already using this material pick up its new resource
+	// when the session finishes its materials.
+	session.addNewMaterial(Material);
 
 	// let the material update itself if necessary
 	Material->PreEditChange(NULL);
@@ -293,10 +483,29 @@ UMaterial* GetOrMakeBaseMaterial(const Zsc::Texture& MatInfo) {
 
 	Material->PostEditChange();
 
+	session.addAsset(ImportSession::MaterialAsset, MaterialName, Material);
 	return Material;
 }
 
-UMaterialInterface* ImportMaterial(const FString& PackageName, FString& MaterialName, const Zsc::Texture& TexData, UTexture *Texture) {
+// Identifies what a material instance ends up looking like: its texture, its
+// base material and the clip value, which is only overridden for alpha tested
+// materials that don't use the default reference. Flags the material doesn't
+// use, like the blend type, are left out so they don't split instances.
+FString GetMaterialInstanceKey(const Zsc::Texture& TexData, UTexture *Texture) {
+	uint16 AlphaReference = TexData.alphaTestEnabled ? TexData.alphaReference : 128;
+	return FString::Printf(TEXT("%s:%s:%d"),
+		Texture ? *Texture->GetPathName() : TEXT("None"), *GetBaseMaterialName(TexData), AlphaReference);
+}
+
+UMaterialInterface* ImportMaterial(ImportSession& session, const FString& PackageName, FString& MaterialName, const Zsc::Texture& TexData, UTexture *Texture) {
+	// Parts that look the same share one instance, whatever they're named.
+	FString InstanceKey = GetMaterialInstanceKey(TexData, Texture);
+	UMaterialInterface* SessionMaterial = session.findAsset<UMaterialInterface>(ImportSession::MaterialInstanceAsset, InstanceKey);
+	if (SessionMaterial != NULL) {
+		MaterialName = SessionMaterial->GetName();
+		return SessionMaterial;
+	}
+
 	UPackage* Package = GetOrMakePackage(PackageName, MaterialName);
 	if (Package == NULL) {
 		return NULL;
@@ -314,11 +523,9 @@ UMaterialInterface* ImportMaterial(const FString& PackageName, FString& Material
 	// Set the dirty flag so this package will get saved later
 	Material->MarkPackageDirty();
 
-	UMaterial* BaseMaterial = GetOrMakeBaseMaterial(TexData);
+	UMaterial* BaseMaterial = GetOrMakeBaseMaterial(session, TexData);
 
-	// make sure that any static meshes, etc using this material will stop using the FMaterialResource of the original 
-	// material, and will use the new FMaterialResource created when we make a new UMaterial in place
-	FGlobalComponentReregisterContext RecreateComponentsX;
+	session.addNewMaterial(Material);
 
 	// let the material update itself if necessary
 	Material->PreEditChange(NULL);
@@ -334,6 +541,7 @@ UMaterialInterface* ImportMaterial(const FString& PackageName, FString& Material
 
 	Material->PostEditChange();
 
+	session.addAsset(ImportSession::MaterialInstanceAsset, InstanceKey, Material);
 	return Material;
 }
 
@@ -621,26 +829,20 @@ UAnimSequence *ImportSkeletalAnim(const FString& PackageName, FString& AnimName,
 	}
 
 	for (int i = 0; i < anim.channels.Num(); ++i) {
-		Zmo::Channel *channel = anim.channels[i];
-		FRawAnimSequenceTrack& track = tracks[channel->index];
-		if (channel->type() == Zmo::ChannelType::Position) {
-			auto posChannel = (Zmo::PositionChannel*)channel;
-			track.PosKeys.Empty();
-			for (int j = 0; j < posChannel->frames.Num(); ++j) {
-				track.PosKeys.Add(posChannel->frames[j]);
-			}
-		} else if (channel->type() == Zmo::ChannelType::Rotation) {
-			auto rotChannel = (Zmo::RotationChannel*)channel;
-			track.RotKeys.Empty();
-			for (int j = 0; j < rotChannel->frames.Num(); ++j) {
-				track.RotKeys.Add(rotChannel->frames[j]);
-			}
-		} else if (channel->type() == Zmo::ChannelType::Scale) {
-			auto scaleChannel = (Zmo::ScaleChannel*)channel;
-			track.ScaleKeys.Empty();
-			for (int j = 0; j < scaleChannel->frames.Num(); ++j) {
-				track.ScaleKeys.Add(scaleChannel->frames[j]);
-			}
+		const Zmo::Channel& channel = anim.channels[i];
+		FRawAnimSequenceTrack& track = tracks[channel.index];
+		if (channel.type == Zmo::ChannelType::Position) {
+			auto frames = anim.positions(channel);
+			track.PosKeys.Empty(frames.Num());
+			track.PosKeys.Append(frames.GetData(), frames.Num());
+		} else if (channel.type == Zmo::ChannelType::Rotation) {
+			auto frames = anim.rotations(channel);
+			track.RotKeys.Empty(frames.Num());
+			track.RotKeys.Append(frames.GetData(), frames.Num());
+		} else if (channel.type == Zmo::ChannelType::Scale) {
+			auto frames = anim.scales(channel);
+			track.ScaleKeys.Empty(frames.Num());
+			track.ScaleKeys.Append(frames.GetData(), frames.Num());
 		} else {
 			DebugBreak();
 		}
@@ -677,7 +879,7 @@ const TCHAR* animNames[] = {
 };
 const int MaxAnims = 11;
 
-void ImportChar(const Chr& chars, const Zsc& meshs, uint32 charIdx) {
+void ImportChar(ImportSession& session, const Chr& chars, const Zsc& meshs, uint32 charIdx) {
 	FString CharName = FString::Printf(TEXT("Char_%d"), charIdx);
 	FString PackageName = FString(TEXT("/")) + CharName;
 
@@ -704,15 +906,15 @@ void ImportChar(const Chr& chars, const Zsc& meshs, uint32 charIdx) {
 			}
 
 			FString TextureName = FString::Printf(TEXT("%s_%d_Texture"), *CharName, texIdx);
-			UTexture* UnrealTexture = ImportTexture(PackageName, TextureName, RoseBasePath + tex.filePath);
+			UTexture* UnrealTexture = ImportTexture(session, PackageName, TextureName, RoseBasePath + tex.filePath.ToString());
 
 			FString MaterialName = FString::Printf(TEXT("%s_%d_Material"), *CharName, texIdx);
-			UMaterialInterface *UnrealMaterial = ImportMaterial( PackageName, MaterialName, tex, UnrealTexture);
+			UMaterialInterface *UnrealMaterial = ImportMaterial(session, PackageName, MaterialName, tex, UnrealTexture);
 
 			meshData.materials.Add(UnrealMaterial);
 
-			auto meshZms = new Zms(*(RoseBasePath + meshs.meshes[part.meshIdx]));
-			meshData.meshes.Add(ImportMeshData::Item(*meshZms, texIdx));
+			Zms& meshZms = session.loadZms(RoseBasePath + meshs.meshes[part.meshIdx].ToString(), Zms::ZMSF_NORMAL | Zms::ZMSF_UV1 | Zms::ZMSF_SKIN);
+			meshData.meshes.Add(ImportMeshData::Item(meshZms, texIdx));
 
 			texIdx++;
 		}
@@ -734,7 +936,7 @@ void ImportChar(const Chr& chars, const Zsc& meshs, uint32 charIdx) {
 	}
 }
 
-USkeletalMesh* ImportAvatarItem(const FString& ItemTypeName, const Zsc& meshs, ImportSkelData& skelData, int modelIdx, int boneIdx = -1) {
+USkeletalMesh* ImportAvatarItem(ImportSession& session, const FString& ItemTypeName, const Zsc& meshs, ImportSkelData& skelData, int modelIdx, int boneIdx = -1) {
 	const Zsc::Model& model = meshs.models[modelIdx];
 	ImportMeshData meshData;
 
@@ -750,20 +952,20 @@ USkeletalMesh* ImportAvatarItem(const FString& ItemTypeName, const Zsc& meshs, I
 			continue;
 		}
 
-		FString ZmsPath = meshs.meshes[part.meshIdx];
+		FString ZmsPath = meshs.meshes[part.meshIdx].ToString();
 
 		FString TexturePackage, TextureName;
-		BuildAssetPath(TexturePackage, TextureName, tex.filePath, "_Texture");
-		UTexture* UnrealTexture = ImportTexture(TexturePackage, TextureName, RoseBasePath + tex.filePath);
+		BuildAssetPath(TexturePackage, TextureName, tex.filePath.ToString(), "_Texture");
+		UTexture* UnrealTexture = ImportTexture(session, TexturePackage, TextureName, RoseBasePath + tex.filePath.ToString());
 
 		FString MaterialPackage, MaterialName;
 		BuildAssetPath(MaterialPackage, MaterialName, ZmsPath);
 		MaterialName = FString::Printf(TEXT("Model_%d_%d_Material"), modelIdx, j);
-		UMaterialInterface *UnrealMaterial = ImportMaterial(MaterialPackage, MaterialName, tex, UnrealTexture);
+		UMaterialInterface *UnrealMaterial = ImportMaterial(session, MaterialPackage, MaterialName, tex, UnrealTexture);
 		meshData.materials.Add(UnrealMaterial);
 
-		auto meshZms = new Zms(*(RoseBasePath + ZmsPath));
-		meshData.meshes.Add(ImportMeshData::Item(*meshZms, j));
+		Zms& meshZms = session.loadZms(RoseBasePath + ZmsPath, Zms::ZMSF_NORMAL | Zms::ZMSF_UV1 | Zms::ZMSF_SKIN);
+		meshData.meshes.Add(ImportMeshData::Item(meshZms, j));
 	}
 
 	FString ModelPackage, ModelName;
@@ -809,132 +1011,162 @@ CurveType* CreateCurveObject(UObject* PackagePtr, FName& AssetName)
 }
 
 
-UBlueprint* ImportWorldZscModel(const FString& MdlTypeName, const Zsc& meshs, int modelIdx) {
-	const Zsc::Model& model = meshs.models[modelIdx];
+// Builds the static mesh for one ZMS of a world model, with Material as its
+// only section. MeshFile is the ZMS, already open.
+UStaticMesh* ImportWorldMesh(ImportSession& session, const FString& MeshPath, ReadHelper& MeshFile, UMaterialInterface* Material) {
+	FString ModelPackage, ModelName;
+	BuildAssetPath(ModelPackage, ModelName, MeshPath);
 
-	FString BPPackageName = TEXT("/MAPS");
-	FString BPAssetName = FString::Printf(TEXT("%s_%d"), *MdlTypeName, modelIdx);
+	UPackage* Package = GetOrMakePackage(ModelPackage, ModelName);
+	if (Package == NULL) {
+		return NULL;
+	}
 
-	UPackage* BPPackage = GetOrMakePackage(BPPackageName, BPAssetName);
-	if (BPPackage == NULL) {
+	UStaticMesh* StaticMesh = CastChecked<UStaticMesh>(
+		StaticConstructObject(UStaticMesh::StaticClass(), Package, *ModelName, RF_Standalone | RF_Public));
+	if (StaticMesh == NULL) {
 		return NULL;
 	}
 
-	UBlueprint* Blueprint = FKismetEditorUtilities::CreateBlueprint(
-		AActor::StaticClass(), BPPackage, *BPAssetName,
-		BPTYPE_Normal, UBlueprint::StaticClass(),
-		UBlueprintGeneratedClass::StaticClass(),
-		FName("RosePluginWhat"));
+	// Notify the asset registry
+	FAssetRegistryModule::AssetCreated(StaticMesh);
 
-	USCS_Node* RootNode = NULL;
-	for (int j = 0; j < model.parts.Num(); ++j) {
-		const Zsc::Part& part = model.parts[j];
-		const Zsc::Texture& tex = meshs.textures[part.texIdx];
-		const FString& mesh = meshs.meshes[part.meshIdx];
+	// Set the dirty flag so this package will get saved later
+	StaticMesh->MarkPackageDirty();
 
-		FString ModelPackage, ModelName;
-		BuildAssetPath(ModelPackage, ModelName, mesh);
+	// make sure it has a new lighting guid
+	StaticMesh->LightingGuid = FGuid::NewGuid();
 
-		UPackage* Package = GetOrMakePackage(ModelPackage, ModelName);
-		if (Package == NULL) {
-			return NULL;
-		}
+	// Set it to use textured lightmaps. Note that Build Lighting will do the error-checking (texcoordindex exists for all LODs, etc).
+	StaticMesh->LightMapResolution = 128;
+	StaticMesh->LightMapCoordinateIndex = 1;
 
-		UStaticMesh* StaticMesh = CastChecked<UStaticMesh>(
-			StaticConstructObject(UStaticMesh::StaticClass(), Package, *ModelName, RF_Standalone | RF_Public));
-		if (StaticMesh == NULL) {
-			return NULL;
-		}
+	new(StaticMesh->SourceModels) FStaticMeshSourceModel();
+	FStaticMeshSourceModel& SrcModel = StaticMesh->SourceModels[0];
 
-		// Notify the asset registry
-		FAssetRegistryModule::AssetCreated(StaticMesh);
+	FRawMesh RawMesh;
+	SrcModel.RawMeshBulkData->SaveRawMesh(RawMesh);
+	StaticMesh->Materials.Add(Material);
 
-		// Set the dirty flag so this package will get saved later
-		StaticMesh->MarkPackageDirty();
+	// Static props only need positions, indices and UVs.
+	Zms meshZms(MeshFile, *(RoseBasePath + MeshPath), Zms::ZMSF_UVS);
 
-		// make sure it has a new lighting guid
-		StaticMesh->LightingGuid = FGuid::NewGuid();
+	RawMesh.VertexPositions.AddZeroed(meshZms.vertexPositions.Num());
+	for (int i = 0; i < meshZms.vertexPositions.Num(); ++i) {
+		RawMesh.VertexPositions[i] = meshZms.vertexPositions[i];
+	}
 
-		// Set it to use textured lightmaps. Note that Build Lighting will do the error-checking (texcoordindex exists for all LODs, etc).
-		StaticMesh->LightMapResolution = 128;
-		StaticMesh->LightMapCoordinateIndex = 1;
+	RawMesh.WedgeIndices.AddZeroed(meshZms.indexes.Num());
+	//RawMesh.WedgeTangentX.AddZeroed(meshZms.indexes.Num());
+	//RawMesh.WedgeTangentY.AddZeroed(meshZms.indexes.Num());
+	//RawMesh.WedgeTangentZ.AddZeroed(meshZms.indexes.Num());
+	for (int i = 0; i < meshZms.indexes.Num(); ++i) {
+		RawMesh.WedgeIndices[i] = meshZms.indexes[i];
+		//RawMesh.WedgeTangentZ[indexOffset + i] = meshZms.vertexNormals[meshZms.indexes[i]];
+	}
 
-		new(StaticMesh->SourceModels) FStaticMeshSourceModel();
-		FStaticMeshSourceModel& SrcModel = StaticMesh->SourceModels[0];
+	for (int k = 0; k < 4; ++k) {
+		if (meshZms.vertexUvs[k].Num() > 0) {
+			RawMesh.WedgeTexCoords[k].AddZeroed(meshZms.indexes.Num());
+			for (int i = 0; i < meshZms.indexes.Num(); ++i) {
+				RawMesh.WedgeTexCoords[k][i] = meshZms.vertexUvs[k][meshZms.indexes[i]];
+			}
+		}
+	}
 
-		FRawMesh RawMesh;
-		SrcModel.RawMeshBulkData->SaveRawMesh(RawMesh);
-		{
-			FString TexturePackage, TextureName;
-			BuildAssetPath(TexturePackage, TextureName, tex.filePath, "_Texture");
-			UTexture* UnrealTexture = ImportTexture(TexturePackage, TextureName, RoseBasePath + tex.filePath);
+	int faceCount = meshZms.indexes.Num() / 3;
+	RawMesh.FaceMaterialIndices.AddZeroed(faceCount);
+	RawMesh.FaceSmoothingMasks.AddZeroed(faceCount);
+	for (int i = 0; i < faceCount; ++i) {
+		RawMesh.FaceMaterialIndices[i] = 0;
+		RawMesh.FaceSmoothingMasks[i] = 1;
+	}
+	SrcModel.RawMeshBulkData->SaveRawMesh(RawMesh);
 
-			FString MaterialPackage, MaterialName;
-			BuildAssetPath(MaterialPackage, MaterialName, meshs.meshes[part.meshIdx]);
-			MaterialName = FString::Printf(TEXT("Model_%d_%d_Material"), modelIdx, j);
-			UMaterialInterface *UnrealMaterial = ImportMaterial(MaterialPackage, MaterialName, tex, UnrealTexture);
+	SrcModel.BuildSettings.bRemoveDegenerates = true;
+	SrcModel.BuildSettings.bRecomputeNormals = false;
+	SrcModel.BuildSettings.bRecomputeTangents = false;
 
-			StaticMesh->Materials.Add(UnrealMaterial);
+	StaticMesh->Build(true);
 
-			Zms meshZms(*(RoseBasePath + mesh));
+	// Set up the mesh collision
+	StaticMesh->CreateBodySetup();
 
-			RawMesh.VertexPositions.AddZeroed(meshZms.vertexPositions.Num());
-			for (int i = 0; i < meshZms.vertexPositions.Num(); ++i) {
-				RawMesh.VertexPositions[i] = meshZms.vertexPositions[i];
-			}
+	// Create new GUID
+	StaticMesh->BodySetup->InvalidatePhysicsData();
 
-			RawMesh.WedgeIndices.AddZeroed(meshZms.indexes.Num());
-			//RawMesh.WedgeTangentX.AddZeroed(meshZms.indexes.Num());
-			//RawMesh.WedgeTangentY.AddZeroed(meshZms.indexes.Num());
-			//RawMesh.WedgeTangentZ.AddZeroed(meshZms.indexes.Num());
-			for (int i = 0; i < meshZms.indexes.Num(); ++i) {
-				RawMesh.WedgeIndices[i] = meshZms.indexes[i];
-				//RawMesh.WedgeTangentZ[indexOffset + i] = meshZms.vertexNormals[meshZms.indexes[i]];
-			}
+	// Per-poly collision for now
+	StaticMesh->BodySetup->CollisionTraceFlag = ECollisionTraceFlag::CTF_UseComplexAsSimple;
+	StaticMesh->BodySetup->bDoubleSidedGeometry = true;
 
-			for (int k = 0; k < 4; ++k) {
-				if (meshZms.vertexUvs[k].Num() > 0) {
-					RawMesh.WedgeTexCoords[k].AddZeroed(meshZms.indexes.Num());
-					for (int i = 0; i < meshZms.indexes.Num(); ++i) {
-						RawMesh.WedgeTexCoords[k][i] = meshZms.vertexUvs[k][meshZms.indexes[i]];
-					}
-				}
-			}
+	// refresh collision change back to staticmesh components once the session is done
+	session.addChangedMesh(StaticMesh);
 
-			int faceCount = meshZms.indexes.Num() / 3;
-			RawMesh.FaceMaterialIndices.AddZeroed(faceCount);
-			RawMesh.FaceSmoothingMasks.AddZeroed(faceCount);
-			for (int i = 0; i < faceCount; ++i) {
-				RawMesh.FaceMaterialIndices[i] = 0;
-				RawMesh.FaceSmoothingMasks[i] = 1;
-			}
-		}
-		SrcModel.RawMeshBulkData->SaveRawMesh(RawMesh);
+	for (int32 SectionIndex = 0; SectionIndex < StaticMesh->Materials.Num(); SectionIndex++)
+	{
+		FMeshSectionInfo Info = StaticMesh->SectionInfoMap.Get(0, SectionIndex);
+		Info.bEnableCollision = true;
+		StaticMesh->SectionInfoMap.Set(0, SectionIndex, Info);
+	}
 
-		SrcModel.BuildSettings.bRemoveDegenerates = true;
-		SrcModel.BuildSettings.bRecomputeNormals = false;
-		SrcModel.BuildSettings.bRecomputeTangents = false;
+	return StaticMesh;
+}
 
-		StaticMesh->Build(true);
+UBlueprint* ImportWorldZscModel(ImportSession& session, const FString& MdlTypeName, const Zsc& meshs, int modelIdx) {
+	const Zsc::Model& model = meshs.models[modelIdx];
 
-		// Set up the mesh collision
-		StaticMesh->CreateBodySetup();
+	FString BPPackageName = TEXT("/MAPS");
+	FString BPAssetName = FString::Printf(TEXT("%s_%d"), *MdlTypeName, modelIdx);
 
-		// Create new GUID
-		StaticMesh->BodySetup->InvalidatePhysicsData();
+	FString BPSourceName = BPPackageName / BPAssetName;
+	UBlueprint* SessionBlueprint = session.findAsset<UBlueprint>(ImportSession::BlueprintAsset, BPSourceName);
+	if (SessionBlueprint != NULL) {
+		return SessionBlueprint;
+	}
 
-		// Per-poly collision for now
-		StaticMesh->BodySetup->CollisionTraceFlag = ECollisionTraceFlag::CTF_UseComplexAsSimple;
-		StaticMesh->BodySetup->bDoubleSidedGeometry = true;
+	UPackage* BPPackage = GetOrMakePackage(BPPackageName, BPAssetName);
+	if (BPPackage == NULL) {
+		return NULL;
+	}
 
-		// refresh collision change back to staticmesh components
-		RefreshCollisionChange(StaticMesh);
+	UBlueprint* Blueprint = FKismetEditorUtilities::CreateBlueprint(
+		AActor::StaticClass(), BPPackage, *BPAssetName,
+		BPTYPE_Normal, UBlueprint::StaticClass(),
+		UBlueprintGeneratedClass::StaticClass(),
+		FName("RosePluginWhat"));
 
-		for (int32 SectionIndex = 0; SectionIndex < StaticMesh->Materials.Num(); SectionIndex++)
-		{
-			FMeshSectionInfo Info = StaticMesh->SectionInfoMap.Get(0, SectionIndex);
-			Info.bEnableCollision = true;
-			StaticMesh->SectionInfoMap.Set(0, SectionIndex, Info);
+	USCS_Node* RootNode = NULL;
+	for (int j = 0; j < model.parts.Num(); ++j) {
+		const Zsc::Part& part = model.parts[j];
+		const Zsc::Texture& tex = meshs.textures[part.texIdx];
+		FString mesh = meshs.meshes[part.meshIdx].ToString();
+
+		FString TexturePackage, TextureName;
+		BuildAssetPath(TexturePackage, TextureName, tex.filePath.ToString(), "_Texture");
+		UTexture* UnrealTexture = ImportTexture(session, TexturePackage, TextureName, RoseBasePath + tex.filePath.ToString());
+
+		FString MaterialPackage, MaterialName;
+		BuildAssetPath(MaterialPackage, MaterialName, mesh);
+		MaterialName = FString::Printf(TEXT("Model_%d_%d_Material"), modelIdx, j);
+		UMaterialInterface *UnrealMaterial = ImportMaterial(session, MaterialPackage, MaterialName, tex, UnrealTexture);
+
+		// Parts of different models often share a ZMS, or an identical copy of one,
+		// so each is only built once.
+		UStaticMesh* StaticMesh = session.findAsset<UStaticMesh>(ImportSession::MeshAsset, mesh);
+		if (StaticMesh == NULL) {
+			// The mapped file is hashed and then decoded from, so it is only read once.
+			ReadHelper MeshFile;
+			MeshFile.open(*(RoseBasePath + mesh));
+			FString ContentKey = ImportSession::contentKey(MeshFile.view(), MeshFile.length());
+			StaticMesh = session.findContent<UStaticMesh>(ImportSession::MeshAsset, ContentKey);
+			if (StaticMesh == NULL) {
+				StaticMesh = ImportWorldMesh(session, mesh, MeshFile, UnrealMaterial);
+				if (StaticMesh == NULL) {
+					return NULL;
+				}
+				session.addContent(ImportSession::MeshAsset, ContentKey, StaticMesh);
+			}
+			session.addAsset(ImportSession::MeshAsset, mesh, StaticMesh);
 		}
 
 		FString MeshCompNameX = FString::Printf(TEXT("Part_%d_Component"), j);
@@ -942,6 +1174,9 @@ UBlueprint* ImportWorldZscModel(const FString& MdlTypeName, const Zsc& meshs, in
 			(UStaticMeshComponent*)StaticConstructObject(UStaticMeshComponent::StaticClass(),
 			BPPackage, *MeshCompNameX, RF_Transient);
 		MeshComp->StaticMesh = StaticMesh;
+		if (StaticMesh->Materials[0] != UnrealMaterial) {
+			MeshComp->SetMaterial(0, UnrealMaterial);
+		}
 		
 		FString MeshCompName = FString::Printf(TEXT("Part_%d"), j);
 		USCS_Node* MeshNode = Blueprint->SimpleConstructionScript->CreateNode(MeshComp, *MeshCompName);
@@ -1001,32 +1236,32 @@ UBlueprint* ImportWorldZscModel(const FString& MdlTypeName, const Zsc& meshs, in
 			bool UsesScale = false;
 
 			for (int i = 0; i < anim.channels.Num(); ++i) {
-				Zmo::Channel *channel = anim.channels[i];
-				if (channel->index != 0) {
+				const Zmo::Channel& channel = anim.channels[i];
+				if (channel.index != 0) {
 					DebugBreak();
 				}
 
-				if (channel->type() == Zmo::ChannelType::Position) {
+				if (channel.type == Zmo::ChannelType::Position) {
 					UsesPosition = true;
-					auto posChannel = (Zmo::PositionChannel*)channel;
-					for (int j = 0; j < posChannel->frames.Num(); ++j) {
-						const FVector& frame = posChannel->frames[j];
-						if (j == 0 || frame.X != posChannel->frames[j - 1].X) {
+					auto frames = anim.positions(channel);
+					for (int j = 0; j < frames.Num(); ++j) {
+						const FVector& frame = frames[j];
+						if (j == 0 || frame.X != frames[j - 1].X) {
 							PCurve->FloatCurves[0].AddKey((float)j / (float)anim.framesPerSecond, frame.X);
 						}
-						if (j == 0 || frame.Y != posChannel->frames[j - 1].Y) {
+						if (j == 0 || frame.Y != frames[j - 1].Y) {
 							PCurve->FloatCurves[1].AddKey((float)j / (float)anim.framesPerSecond, frame.Y);
 						}
-						if (j == 0 || frame.Z != posChannel->frames[j - 1].Z) {
+						if (j == 0 || frame.Z != frames[j - 1].Z) {
 							PCurve->FloatCurves[2].AddKey((float)j / (float)anim.framesPerSecond, frame.Z);
 						}
 					}
-				} else if (channel->type() == Zmo::ChannelType::Rotation) {
+				} else if (channel.type == Zmo::ChannelType::Rotation) {
 					UsesRotation = true;
-					auto rotChannel = (Zmo::RotationChannel*)channel;
+					auto frames = anim.rotations(channel);
 					FRotator prevFrame;
-					for (int j = 0; j < rotChannel->frames.Num(); ++j) {
-						FRotator frame = rotChannel->frames[j].Rotator();
+					for (int j = 0; j < frames.Num(); ++j) {
+						FRotator frame = frames[j].Rotator();
 						//if (j == 0 || frame.Pitch != prevFrame.Pitch) {
 							RCurve->FloatCurves[0].AddKey((float)j / (float)anim.framesPerSecond, frame.Pitch, true);
 						//}
@@ -1038,18 +1273,18 @@ UBlueprint* ImportWorldZscModel(const FString& MdlTypeName, const Zsc& meshs, in
 						//}
 						prevFrame = frame;
 					}
-				} else if (channel->type() == Zmo::ChannelType::Scale) {
+				} else if (channel.type == Zmo::ChannelType::Scale) {
 					UsesScale = true;
-					auto scaleChannel = (Zmo::ScaleChannel*)channel;
-					for (int j = 0; j < scaleChannel->frames.Num(); ++j) {
-						const FVector& frame = scaleChannel->frames[j];
-						if (j == 0 || frame.X != scaleChannel->frames[j - 1].X) {
+					auto frames = anim.scales(channel);
+					for (int j = 0; j < frames.Num(); ++j) {
+						const FVector& frame = frames[j];
+						if (j == 0 || frame.X != frames[j - 1].X) {
 							SCurve->FloatCurves[0].AddKey((float)j / (float)anim.framesPerSecond, frame.X);
 						}
-						if (j == 0 || frame.Y != scaleChannel->frames[j - 1].Y) {
+						if (j == 0 || frame.Y != frames[j - 1].Y) {
 							SCurve->FloatCurves[1].AddKey((float)j / (float)anim.framesPerSecond, frame.Y);
 						}
-						if (j == 0 || frame.Z != scaleChannel->frames[j - 1].Z) {
+						if (j == 0 || frame.Z != frames[j - 1].Z) {
 							SCurve->FloatCurves[2].AddKey((float)j / (float)anim.framesPerSecond, frame.Z);
 						}
 					}
@@ -1118,6 +1353,7 @@ UBlueprint* ImportWorldZscModel(const FString& MdlTypeName, const Zsc& meshs, in
 		}
 	}
 
+	session.addAsset(ImportSession::BlueprintAsset, BPSourceName, Blueprint);
 	return Blueprint;
 }
 
@@ -1135,6 +1371,173 @@ AActor* SpawnWorldModel(const FString& NewName, const FString& PackageName, cons
 	return NULL;
 }
 
+// Spawns world models in bulk. Each blueprint's generated class is looked up
+// once, and actors are spawned with deferred construction, so their
+// construction scripts run after the landscape is written rather than
+// between tiles.
+struct WorldModelSpawner {
+	AActor* Spawn(const FString& NewName, const FString& PackageName, const FString& AssetName, const FQuat& Rot, const FVector& Pos, const FVector& Scale, ULevel* Level) {
+		UClass* ModelClass = FindClass(PackageName, AssetName);
+		if (ModelClass == NULL) {
+			return NULL;
+		}
+
+		FActorSpawnParameters SpawnInfo;
+		SpawnInfo.Name = *NewName;
+		SpawnInfo.OverrideLevel = Level;
+		SpawnInfo.bDeferConstruction = true;
+		AActor* ModelAct = GWorld->SpawnActor<AActor>(ModelClass, Pos, FRotator(Rot), SpawnInfo);
+		if (ModelAct) {
+			pendingActors.Add(ModelAct);
+			pendingTransforms.Add(FTransform(Rot, Pos, Scale));
+		}
+		return ModelAct;
+	}
+
+	// Runs the pending construction scripts. FinishSpawning registers each
+	// actor's components as it goes.
+	void Finish() {
+		for (int32 i = 0; i < pendingActors.Num(); ++i) {
+			pendingActors[i]->FinishSpawning(pendingTransforms[i]);
+		}
+		pendingActors.Empty();
+		pendingTransforms.Empty();
+	}
+
+private:
+	UClass* FindClass(const FString& PackageName, const FString& AssetName) {
+		FString Key = PackageName / AssetName;
+		UClass** Found = classes.Find(Key);
+		if (Found) {
+			return *Found;
+		}
+
+		auto Model = GetExistingAsset<UBlueprint>(PackageName, AssetName);
+		UClass* ModelClass = Model ? Model->GeneratedClass : NULL;
+		classes.Add(Key, ModelClass);
+		return ModelClass;
+	}
+
+	TMap<FString, UClass*> classes;
+	TArray<AActor*> pendingActors;
+	TArray<FTransform> pendingTransforms;
+};
+
+// Collects a tile's placements of world models and spawns them as one actor
+// holding an instanced component per model part, instead of an actor per
+// placement. Models with animated parts are left to WorldModelSpawner.
+struct ModelInstancer {
+	struct ModelParts {
+		bool Animated;
+		TArray<UStaticMeshComponent*> Templates;
+		TArray<FTransform> Transforms;
+	};
+
+	// Returns false when the model can't be instanced and needs its own actor.
+	bool AddModel(const FString& PackageName, const FString& AssetName, const FQuat& Rot, const FVector& Pos, const FVector& Scale) {
+		const ModelParts& Parts = FindModel(PackageName, AssetName);
+		if (Parts.Animated || Parts.Templates.Num() == 0) {
+			return false;
+		}
+
+		FTransform ModelTransform(Rot, Pos, Scale);
+		for (int32 i = 0; i < Parts.Templates.Num(); ++i) {
+			TArray<FTransform>& Instances = tileInstances.FindOrAdd(Parts.Templates[i]);
+			Instances.Add(Parts.Transforms[i] * ModelTransform);
+		}
+		return true;
+	}
+
+	// Spawns the instances gathered since the last call, or nothing if there
+	// were none.
+	AActor* SpawnTile(const FString& NewName, ULevel* Level) {
+		if (tileInstances.Num() == 0) {
+			return NULL;
+		}
+
+		FActorSpawnParameters SpawnInfo;
+		SpawnInfo.Name = *NewName;
+		SpawnInfo.OverrideLevel = Level;
+		AActor* TileAct = GWorld->SpawnActor<AActor>(AActor::StaticClass(), FVector::ZeroVector, FRotator::ZeroRotator, SpawnInfo);
+
+		if (TileAct) {
+			USceneComponent* Root = ConstructObject<USceneComponent>(USceneComponent::StaticClass(), TileAct, TEXT("Root"));
+			Root->SetMobility(EComponentMobility::Static);
+			TileAct->SetRootComponent(Root);
+			Root->RegisterComponent();
+
+			int32 CompIdx = 0;
+			for (auto It = tileInstances.CreateConstIterator(); It; ++It) {
+				const UStaticMeshComponent* Template = It.Key();
+				FString CompName = FString::Printf(TEXT("%s_%d"), *Template->StaticMesh->GetName(), CompIdx++);
+				UInstancedStaticMeshComponent* Comp = ConstructObject<UInstancedStaticMeshComponent>(
+					UInstancedStaticMeshComponent::StaticClass(), TileAct, *CompName);
+				Comp->StaticMesh = Template->StaticMesh;
+				for (int32 i = 0; i < Template->GetNumMaterials(); ++i) {
+					Comp->SetMaterial(i, Template->GetMaterial(i));
+				}
+				Comp->SetMobility(EComponentMobility::Static);
+				Comp->BodyInstance.CopyBodyInstancePropertiesFrom(&Template->BodyInstance);
+				Comp->AttachTo(Root);
+
+				const TArray<FTransform>& Instances = It.Value();
+				for (int32 i = 0; i < Instances.Num(); ++i) {
+					Comp->AddInstance(Instances[i]);
+				}
+				Comp->RegisterComponent();
+			}
+		}
+
+		tileInstances.Empty();
+		return TileAct;
+	}
+
+private:
+	// Reads the parts back out of the model's blueprint. The first node is
+	// the root part, and ImportWorldZscModel attaches all others directly to it.
+	// A spawned actor's root component takes the spawn transform and ignores
+	// the template's relative one, so the root part sits at the model transform
+	// and the other parts are relative to that, as they are on actors.
+	const ModelParts& FindModel(const FString& PackageName, const FString& AssetName) {
+		ModelParts* Found = models.Find(AssetName);
+		if (Found) {
+			return *Found;
+		}
+
+		ModelParts& Parts = models.Add(AssetName);
+		Parts.Animated = false;
+
+		auto Model = GetExistingAsset<UBlueprint>(PackageName, AssetName);
+		if (Model == NULL || Model->SimpleConstructionScript == NULL) {
+			return Parts;
+		}
+
+		TArray<USCS_Node*> Nodes = Model->SimpleConstructionScript->GetAllNodes();
+		for (int32 i = 0; i < Nodes.Num(); ++i) {
+			UStaticMeshComponent* Template = Cast<UStaticMeshComponent>(Nodes[i]->ComponentTemplate);
+			if (Template == NULL || Template->StaticMesh == NULL) {
+				continue;
+			}
+			if (Template->Mobility != EComponentMobility::Static) {
+				Parts.Animated = true;
+			}
+
+			if (Parts.Templates.Num() == 0) {
+				Parts.Transforms.Add(FTransform::Identity);
+			} else {
+				Parts.Transforms.Add(FTransform(Template->RelativeRotation, Template->RelativeLocation, Template->RelativeScale3D));
+			}
+			Parts.Templates.Add(Template);
+		}
+		return Parts;
+	}
+
+	TMap<FString, ModelParts> models;
+	// Grouped by part template rather than by mesh, as parts sharing a mesh
+	// can override its material or collision differently.
+	TMap<const UStaticMeshComponent*, TArray<FTransform>> tileInstances;
+};
+
 void CreateBrushForVolumeActor(AVolume* NewActor, UBrushBuilder* BrushBuilder)
 {
 	if (NewActor != NULL)
@@ -1170,6 +1573,474 @@ void CreateBrushForVolumeActor(AVolume* NewActor, UBrushBuilder* BrushBuilder)
 	}
 }
 
+// Decodes the requested files of one map tile on a worker thread. Files the
+// tile doesn't have are left null, since zones aren't rectangular.
+class LoadTileTask : public FNonAbandonableTask {
+public:
+	enum {
+		LoadTil = 1,
+		LoadHim = 2,
+		LoadIfo = 4,
+	};
+
+	LoadTileTask(const FString& _TilePath, uint32 _Files) : TilePath(_TilePath), Files(_Files) {}
+
+	void DoWork() {
+		if ((Files & LoadTil) && FPaths::FileExists(TilePath + TEXT(".til"))) {
+			tilData = new Til(*(TilePath + TEXT(".til")));
+		}
+		if ((Files & LoadHim) && FPaths::FileExists(TilePath + TEXT(".him"))) {
+			himData = new Him(*(TilePath + TEXT(".him")));
+		}
+		if ((Files & LoadIfo) && FPaths::FileExists(TilePath + TEXT(".ifo"))) {
+			ifoData = new Ifo(*(TilePath + TEXT(".ifo")));
+		}
+	}
+
+	static const TCHAR* Name() {
+		return TEXT("LoadTileTask");
+	}
+
+	FString TilePath;
+	uint32 Files;
+	TScopedPointer<Til> tilData;
+	TScopedPointer<Him> himData;
+	TScopedPointer<Ifo> ifoData;
+};
+
+// Rasterises one tile's heights and normalised splat weights into the shared
+// landscape buffers. Neighbouring tiles share their edge sample, so a tile
+// only writes samples 0..63 on each axis, plus 64 when it is the last tile on
+// that axis. The cells of the tiles before it that touch its first row and
+// column are looked up through neighbourTils, so the tasks never write the
+// same sample.
+class RasterTileTask : public FNonAbandonableTask {
+public:
+	void DoWork() {
+		int32 countX = lastX ? 65 : 64;
+		int32 countY = lastY ? 65 : 64;
+
+		// Each TIL cell spans 4 pixels plus the shared pixel on its far edge,
+		// so pixels on a multiple of 4 are covered by the cells on both sides
+		// and the 3 between them only by their own cell. Every pixel is
+		// written once, with the weights of the brushes covering it summing to 255.
+		for (int32 PixelY = 0; PixelY < countY; ++PixelY) {
+			int32 cellRows[2];
+			int32 rowCount = 0;
+			if (PixelY / 4 < 16) {
+				cellRows[rowCount++] = PixelY / 4;
+			}
+			if (PixelY % 4 == 0) {
+				cellRows[rowCount++] = PixelY / 4 - 1;
+			}
+
+			int32 rowBase = (baseY + PixelY) * pitch + baseX;
+			for (int32 cx = 0; cx * 4 < countX; ++cx) {
+				uint8 brushes[4];
+				int32 brushCount = gatherBrushes(brushes, cellRows, rowCount, cx, true);
+				splatWeights(brushes, brushCount, rowBase + cx * 4, 1);
+
+				if (cx < 16) {
+					brushCount = gatherBrushes(brushes, cellRows, rowCount, cx, false);
+					splatWeights(brushes, brushCount, rowBase + cx * 4 + 1, FMath::Min(3, countX - cx * 4 - 1));
+				}
+			}
+		}
+
+		// Whole rows are quantised so the bounds still cover the samples this tile doesn't own.
+		minHeight = +1000000;
+		maxHeight = -1000000;
+		if (!himData) {
+			return;
+		}
+
+		uint16 rowData[65];
+		for (int32 sy = 0; sy < himData->size; ++sy) {
+			Span<const float> hmRow = himData->row(sy);
+			quantizeHeights(rowData, hmRow.GetData(), hmRow.Num(), minHeight, maxHeight);
+			if (sy < countY) {
+				FMemory::Memcpy(&heightData[(baseY + sy) * pitch + baseX], rowData, sizeof(uint16) * countX);
+			}
+		}
+	}
+
+	static const TCHAR* Name() {
+		return TEXT("RasterTileTask");
+	}
+
+	// Brushes of the cells in `cellRows` at column cx, and at cx - 1 too when
+	// `boundary` is set. Cells outside the loaded tiles are left out.
+	int32 gatherBrushes(uint8* brushes, const int32* cellRows, int32 rowCount, int32 cx, bool boundary) const {
+		int32 count = 0;
+		for (int32 r = 0; r < rowCount; ++r) {
+			int32 cy = cellRows[r];
+			for (int32 x = boundary ? cx - 1 : cx; x <= cx; ++x) {
+				const Til* tilData = neighbourTils[cy >= 0][x >= 0];
+				if (x >= 16 || !tilData) {
+					continue;
+				}
+
+				uint8 BrushIdx = tilData->Data[((cy + 16) % 16) * 16 + (x + 16) % 16].Brush;
+				check(BrushIdx < 8);
+				brushes[count++] = BrushIdx;
+			}
+		}
+		return count;
+	}
+
+	// Writes `length` pixels from `index` with each brush weighted by its
+	// share of the covering cells. The first brush takes the rounding leftover.
+	void splatWeights(const uint8* brushes, int32 brushCount, int32 index, int32 length) {
+		if (brushCount == 0) {
+			return;
+		}
+
+		int32 cellCounts[8] = { 0 };
+		for (int32 i = 0; i < brushCount; ++i) {
+			cellCounts[brushes[i]]++;
+		}
+
+		int32 remainder = 255;
+		for (int32 BrushIdx = 0; BrushIdx < 8; ++BrushIdx) {
+			if (cellCounts[BrushIdx] == 0 || BrushIdx == brushes[0]) {
+				continue;
+			}
+
+			uint8 weight = (uint8)(255 * cellCounts[BrushIdx] / brushCount);
+			FMemory::Memset(&weightData[BrushIdx][index], weight, length);
+			remainder -= weight;
+		}
+		FMemory::Memset(&weightData[brushes[0]][index], (uint8)remainder, length);
+	}
+
+	// [y][x] with 0 for the tile before this one on that axis; [1][1] is this tile.
+	const Til* neighbourTils[2][2];
+	const Him* himData;
+	bool lastX, lastY;
+	int32 baseX, baseY;
+	int32 pitch;
+	uint16* heightData;
+	uint8* weightData[8];
+
+	float minHeight;
+	float maxHeight;
+};
+
+// Spawns the buildings, decorations and collision volumes one tile's IFO places.
+// Level is where the tile's actors go; NULL spawns them into the current level.
+// Model actors are only constructed once Spawner is finished. With an
+// Instancer, models without animated parts are instanced rather than each
+// getting an actor.
+void SpawnTileObjects(const FString& CnstPackageName, const Ifo& ifoData, int ix, int iy, bool ImportBuildings, bool ImportObjects, bool ImportCollisions,
+	WorldModelSpawner& Spawner, ULevel* Level, ModelInstancer* Instancer) {
+	if (ImportBuildings) {
+		for (int32 i = 0; i < ifoData.Buildings.Num(); ++i) {
+			const Ifo::FBuildingBlock& obj = ifoData.Buildings[i];
+			FString ObjName = FString::Printf(TEXT("Bldg_%d_%d_%d"), ix, iy, i);
+			FString AssetName = FString::Printf(TEXT("JDTC_%d"), obj.ObjectID);
+			if (Instancer && Instancer->AddModel(CnstPackageName, AssetName, obj.Rotation, obj.Position, obj.Scale)) {
+				continue;
+			}
+			Spawner.Spawn(ObjName, CnstPackageName, AssetName, obj.Rotation, obj.Position, obj.Scale, Level);
+		}
+	}
+	if (ImportObjects) {
+		for (int32 i = 0; i < ifoData.Objects.Num(); ++i) {
+			const Ifo::FObjectBlock& obj = ifoData.Objects[i];
+			FString ObjName = FString::Printf(TEXT("Deco_%d_%d_%d"), ix, iy, i);
+			FString AssetName = FString::Printf(TEXT("JDTD_%d"), obj.ObjectID);
+			if (Instancer && Instancer->AddModel(CnstPackageName, AssetName, obj.Rotation, obj.Position, obj.Scale)) {
+				continue;
+			}
+			Spawner.Spawn(ObjName, CnstPackageName, AssetName, obj.Rotation, obj.Position, obj.Scale, Level);
+		}
+	}
+	if (ImportCollisions) {
+		for (int32 i = 0; i < ifoData.Collisions.Num(); ++i) {
+			const Ifo::FCollisionBlock& obj = ifoData.Collisions[i];
+
+			FVector ColSize(120.0f * obj.Scale.X, 6.8f * obj.Scale.Y, 252.2f * obj.Scale.Z);
+			FVector RecenterPos =
+				FRotationTranslationMatrix(FRotator(obj.Rotation), FVector::ZeroVector)
+				.TransformPosition(FVector(0, 0, -ColSize.Z / 2));
+
+			FActorSpawnParameters SpawnInfo;
+			SpawnInfo.Name = *FString::Printf(TEXT("Collision_%d_%d_%d"), ix, iy, i);
+			SpawnInfo.OverrideLevel = Level;
+			ABlockingVolume* ObjColl = GWorld->SpawnActor<ABlockingVolume>(
+				obj.Position - RecenterPos, FRotator(obj.Rotation), SpawnInfo);
+
+			if (ObjColl) {
+				UCubeBuilder* Builder = ConstructObject<UCubeBuilder>(UCubeBuilder::StaticClass());
+				Builder->X = ColSize.X;
+				Builder->Y = ColSize.Y;
+				Builder->Z = ColSize.Z;
+				CreateBrushForVolumeActor(ObjColl, Builder);
+
+				ObjColl->BrushComponent->BuildSimpleBrushCollision();
+				if (ObjColl->BrushComponent->IsPhysicsStateCreated()) {
+					ObjColl->BrushComponent->RecreatePhysicsState();
+				}
+
+				ObjColl->BrushComponent->SetCollisionResponseToAllChannels(ECR_Block);
+				ObjColl->BrushComponent->SetCollisionResponseToChannel(ECC_Visibility, ECR_Ignore);
+				ObjColl->BrushComponent->SetCollisionResponseToChannel(ECC_Camera, ECR_Ignore);
+			}
+		}
+	}
+
+	if (Instancer) {
+		Instancer->SpawnTile(FString::Printf(TEXT("Instances_%d_%d"), ix, iy), Level);
+	}
+}
+
+// Creates a sublevel for the block of Tiles x Tiles map tiles starting at
+// ix, iy, saved next to the imported assets and streamed in by a volume
+// spanning the block plus StreamingRadius tiles on each side. Streaming
+// volumes have to live in the persistent level, which is also made current
+// again so nothing else lands in the new sublevel.
+ULevel* CreateTileSublevel(const FString& LevelName, int ix, int iy, int Tiles, int StreamingRadius) {
+	FString LevelPackageName = FString::Printf(TEXT("%s/MAPS/%s"), *RosePackageName, *LevelName);
+	FString LevelFilename = FPackageName::LongPackageNameToFilename(LevelPackageName, FPackageName::GetMapPackageExtension());
+
+	ULevel* Level = EditorLevelUtils::CreateNewLevel(GWorld, false, ULevelStreamingKismet::StaticClass(), LevelFilename);
+	GWorld->SetCurrentLevel(GWorld->PersistentLevel);
+	if (!Level) {
+		UE_LOG(RosePlugin, Warning, TEXT("Failed to create sublevel %s"), *LevelPackageName);
+		return NULL;
+	}
+
+	ULevelStreaming* StreamingLevel = FLevelUtils::FindStreamingLevel(Level);
+	if (StreamingLevel) {
+		FActorSpawnParameters SpawnInfo;
+		SpawnInfo.Name = *(TEXT("Streaming_") + LevelName);
+		SpawnInfo.OverrideLevel = GWorld->PersistentLevel;
+		FVector BlockCenter((ix - 32) * 16000 - 8000 + Tiles * 8000, (iy - 32) * 16000 - 8000 + Tiles * 8000, 0);
+		ALevelStreamingVolume* Volume = GWorld->SpawnActor<ALevelStreamingVolume>(BlockCenter, FRotator(0, 0, 0), SpawnInfo);
+
+		if (Volume) {
+			UCubeBuilder* Builder = ConstructObject<UCubeBuilder>(UCubeBuilder::StaticClass());
+			Builder->X = 16000.0f * (Tiles + 2 * StreamingRadius);
+			Builder->Y = 16000.0f * (Tiles + 2 * StreamingRadius);
+			Builder->Z = 102400.0f;
+			CreateBrushForVolumeActor(Volume, Builder);
+
+			// The volume only streams the level once its own references
+			// are rebuilt from the editor list.
+			StreamingLevel->EditorStreamingVolumes.Add(Volume);
+			Volume->UpdateStreamingLevelsRefs();
+			GWorld->PersistentLevel->MarkPackageDirty();
+		}
+	}
+
+	return Level;
+}
+
+// Finds the bounds of a zone's tile grid from the HIM files it has.
+bool FindZoneTileRange(const FString& ZonePath, int& startX, int& startY, int& endX, int& endY) {
+	TArray<FString> HimFiles;
+	IFileManager::Get().FindFiles(HimFiles, *(ZonePath + TEXT("*.him")), true, false);
+
+	bool found = false;
+	for (int32 i = 0; i < HimFiles.Num(); ++i) {
+		FString TileX, TileY;
+		if (!FPaths::GetBaseFilename(HimFiles[i]).Split(TEXT("_"), &TileX, &TileY)) {
+			continue;
+		}
+
+		int ix = FCString::Atoi(*TileX);
+		int iy = FCString::Atoi(*TileY);
+		if (!found) {
+			startX = endX = ix;
+			startY = endY = iy;
+			found = true;
+		} else {
+			startX = FMath::Min(startX, ix);
+			startY = FMath::Min(startY, iy);
+			endX = FMath::Max(endX, ix);
+			endY = FMath::Max(endY, iy);
+		}
+	}
+	return found;
+}
+
+// A component layout the landscape editor supports, sized for some area.
+struct LandscapeLayout {
+	int32 SubsectionSizeQuads;
+	int32 NumSubsections;
+	int32 ComponentSizeQuads;
+	int32 ComponentsX;
+	int32 ComponentsY;
+	int32 SizeX;
+	int32 SizeY;
+	int64 Cost;
+};
+
+// Picks the section size and subsection count covering QuadsX by QuadsY with
+// the least padding and the fewest components. Each component is charged
+// like COMPONENT_COST padding vertices, since it costs a draw call and its own
+// textures however little of it is used.
+LandscapeLayout ChooseLandscapeLayout(int32 QuadsX, int32 QuadsY) {
+	static const int32 SectionSizes[] = { 7, 15, 31, 63, 127, 255 };
+	const int64 COMPONENT_COST = 64 * 64;
+
+	LandscapeLayout Best;
+	Best.Cost = MAX_int64;
+	for (int32 i = 0; i < ARRAY_COUNT(SectionSizes); ++i) {
+		for (int32 NumSubsections = 1; NumSubsections <= 2; ++NumSubsections) {
+			LandscapeLayout Layout;
+			Layout.SubsectionSizeQuads = SectionSizes[i];
+			Layout.NumSubsections = NumSubsections;
+			Layout.ComponentSizeQuads = SectionSizes[i] * NumSubsections;
+			Layout.ComponentsX = FMath::DivideAndRoundUp(QuadsX, Layout.ComponentSizeQuads);
+			Layout.ComponentsY = FMath::DivideAndRoundUp(QuadsY, Layout.ComponentSizeQuads);
+			Layout.SizeX = Layout.ComponentsX * Layout.ComponentSizeQuads + 1;
+			Layout.SizeY = Layout.ComponentsY * Layout.ComponentSizeQuads + 1;
+
+			int64 Padding = (int64)Layout.SizeX * Layout.SizeY - (int64)(QuadsX + 1) * (QuadsY + 1);
+			int64 Components = (int64)Layout.ComponentsX * Layout.ComponentsY;
+			Layout.Cost = Padding + COMPONENT_COST * Components;
+			if (Layout.Cost < Best.Cost) {
+				Best = Layout;
+			}
+		}
+	}
+	return Best;
+}
+
+// Creates flat components over the whole landscape one at a time, so the
+// heights can be streamed in afterwards instead of imported as one heightmap.
+// Each component goes to the proxy ProxyFor(cx, cy) returns, which is either
+// the landscape itself or a streaming proxy sharing its properties. Like
+// ALandscapeProxy::Import, neighbouring components of the same proxy share
+// one heightmap texture of up to MaxHeightmapSize square.
+template<typename TProxyFor>
+void CreateLandscapeComponents(ALandscape* Landscape, const LandscapeLayout& Layout, TProxyFor ProxyFor) {
+	const int32 MaxHeightmapSize = 512;
+
+	int32 ComponentSizeQuads = Layout.ComponentSizeQuads;
+	Landscape->ComponentSizeQuads = ComponentSizeQuads;
+	Landscape->SubsectionSizeQuads = Layout.SubsectionSizeQuads;
+	Landscape->NumSubsections = Layout.NumSubsections;
+	Landscape->SetLandscapeGuid(FGuid::NewGuid());
+
+	ULandscapeInfo* LandscapeInfo = Landscape->GetLandscapeInfo(true);
+
+	// Subsections each keep their own edge vertices.
+	int32 ComponentVerts = (Layout.SubsectionSizeQuads + 1) * Layout.NumSubsections;
+	int32 ComponentsPerHeightmap = FMath::Max(1, MaxHeightmapSize / ComponentVerts);
+	int32 HeightmapSize = FMath::RoundUpToPowerOfTwo(ComponentsPerHeightmap * ComponentVerts);
+
+	// Heightmaps are kept per proxy, as proxies may live in different levels.
+	TMap<ALandscapeProxy*, TMap<FIntPoint, UTexture2D*>> ProxyHeightmaps;
+	TArray<UTexture2D*> Heightmaps;
+
+	TArray<ALandscapeProxy*> Proxies;
+	TArray<ULandscapeComponent*> Components;
+	for (int32 cy = 0; cy < Layout.ComponentsY; ++cy) {
+		for (int32 cx = 0; cx < Layout.ComponentsX; ++cx) {
+			ALandscapeProxy* Proxy = ProxyFor(cx, cy);
+			Proxies.AddUnique(Proxy);
+
+			ULandscapeComponent* Component = ConstructObject<ULandscapeComponent>(ULandscapeComponent::StaticClass(), Proxy, NAME_None, RF_Transactional);
+			Proxy->LandscapeComponents.Add(Component);
+			Component->Init(cx * ComponentSizeQuads, cy * ComponentSizeQuads, ComponentSizeQuads, Layout.NumSubsections, Layout.SubsectionSizeQuads);
+			Component->AttachTo(Proxy->GetRootComponent());
+
+			UTexture2D*& Heightmap = ProxyHeightmaps.FindOrAdd(Proxy).FindOrAdd(FIntPoint(cx / ComponentsPerHeightmap, cy / ComponentsPerHeightmap));
+			if (Heightmap == NULL) {
+				Heightmap = Proxy->CreateLandscapeTexture(HeightmapSize, HeightmapSize, TEXTUREGROUP_Terrain_Heightmap, TSF_BGRA8);
+				Heightmaps.Add(Heightmap);
+			}
+
+			int32 OffsetX = (cx % ComponentsPerHeightmap) * ComponentVerts;
+			int32 OffsetY = (cy % ComponentsPerHeightmap) * ComponentVerts;
+			Component->HeightmapTexture = Heightmap;
+			Component->HeightmapScaleBias = FVector4(1.0f / HeightmapSize, 1.0f / HeightmapSize,
+				(float)OffsetX / HeightmapSize, (float)OffsetY / HeightmapSize);
+			Components.Add(Component);
+
+			LandscapeInfo->XYtoComponentMap.Add(FIntPoint(cx, cy), Component);
+		}
+	}
+
+	// Mid-height with an upward normal, packed the way heightmap textures
+	// store it, at every mip since the whole surface is flat.
+	for (int32 h = 0; h < Heightmaps.Num(); ++h) {
+		UTexture2D* Heightmap = Heightmaps[h];
+		for (int32 Mip = 0; Mip < Heightmap->Source.GetNumMips(); ++Mip) {
+			int32 MipSize = FMath::Max(HeightmapSize >> Mip, 1);
+			FColor* MipData = (FColor*)Heightmap->Source.LockMip(Mip);
+			for (int32 i = 0; i < MipSize * MipSize; ++i) {
+				MipData[i] = FColor(128, 0, 128, 128);
+			}
+			Heightmap->Source.UnlockMip(Mip);
+		}
+		Heightmap->PostEditChange();
+	}
+
+	for (int32 i = 0; i < Components.Num(); ++i) {
+		UTexture2D* Heightmap = Components[i]->HeightmapTexture;
+		FColor* MipData = (FColor*)Heightmap->Source.LockMip(0);
+		Components[i]->UpdateCollisionHeightData(MipData);
+		Heightmap->Source.UnlockMip(0);
+		Components[i]->UpdateCachedBounds();
+	}
+
+	UE_LOG(RosePlugin, Log, TEXT("Created %d landscape components over %d heightmaps of %dx%d"),
+		Components.Num(), Heightmaps.Num(), HeightmapSize, HeightmapSize);
+
+	for (int32 i = 0; i < Proxies.Num(); ++i) {
+		Proxies[i]->RegisterAllComponents();
+	}
+}
+
+// Writes a region's weights to the components it overlaps. Each component
+// only gets the layers whose brush occurs in its part of the region, so its
+// weightmaps sample as few layers as the terrain allows. Components share
+// their edge vertices, which both write with the same weights. Returns the
+// number of component layers written.
+int32 WriteComponentWeights(FLandscapeEditDataInterface& LandscapeEdit, const TArray<FLandscapeImportLayerInfo>& LayerInfos, const TArray<int32>& LayerBrushes,
+	const TArray<uint8>* WeightData, int32 RegionX, int32 RegionY, int32 RegionSizeX, int32 RegionSizeY, int32 ComponentSizeQuads) {
+	int32 RegionEndX = RegionX + RegionSizeX - 1;
+	int32 RegionEndY = RegionY + RegionSizeY - 1;
+	int32 ComponentLayerCount = 0;
+	for (int32 cy = RegionY / ComponentSizeQuads; cy * ComponentSizeQuads < RegionEndY; ++cy) {
+		for (int32 cx = RegionX / ComponentSizeQuads; cx * ComponentSizeQuads < RegionEndX; ++cx) {
+			int32 X1 = FMath::Max(cx * ComponentSizeQuads, RegionX);
+			int32 Y1 = FMath::Max(cy * ComponentSizeQuads, RegionY);
+			int32 X2 = FMath::Min(cx * ComponentSizeQuads + ComponentSizeQuads, RegionEndX);
+			int32 Y2 = FMath::Min(cy * ComponentSizeQuads + ComponentSizeQuads, RegionEndY);
+
+			for (int32 i = 0; i < LayerInfos.Num(); ++i) {
+				const TArray<uint8>& Weights = WeightData[LayerBrushes[i]];
+				if (Weights.Num() == 0) {
+					continue;
+				}
+
+				bool Used = false;
+				for (int32 y = Y1; y <= Y2 && !Used; ++y) {
+					const uint8* Row = &Weights[(y - RegionY) * RegionSizeX];
+					for (int32 x = X1 - RegionX; x <= X2 - RegionX; ++x) {
+						if (Row[x] != 0) {
+							Used = true;
+							break;
+						}
+					}
+				}
+				if (!Used) {
+					continue;
+				}
+
+				const uint8* Data = &Weights[(Y1 - RegionY) * RegionSizeX + (X1 - RegionX)];
+				LandscapeEdit.SetAlphaData(LayerInfos[i].LayerInfo, X1, Y1, X2, Y2, Data, RegionSizeX, ELandscapeLayerPaintingRestriction::None, false, false);
+				ComponentLayerCount++;
+			}
+		}
+	}
+	return ComponentLayerCount;
+}
+
 void FBrettPlugin::StartButton_Clicked()
 {
 	GWarn->BeginSlowTask(NSLOCTEXT("RosePlugin", "SlowWorking", "We are working on importing the map!"), true);
@@ -1184,9 +2055,11 @@ void FBrettPlugin::StartButton_Clicked()
 	FString MaleSkelName = TEXT("MALE_Skeleton");
 	ImportSkelData skelData(meshZmd, MaleSkelPackage, MaleSkelName);
 
-	ImportAvatarItem(TEXT("MBODY"), meshs, skelData, 1);
-	ImportAvatarItem(TEXT("MARMS"), meshs2, skelData, 1);
-	ImportAvatarItem(TEXT("MFOOT"), meshs3, skelData, 1);
+	ImportSession session;
+	ImportAvatarItem(session, TEXT("MBODY"), meshs, skelData, 1);
+	ImportAvatarItem(session, TEXT("MARMS"), meshs2, skelData, 1);
+	ImportAvatarItem(session, TEXT("MFOOT"), meshs3, skelData, 1);
+	session.reset();
 
 
 	Zmo animZmo(*(RoseBasePath + TEXT("3DDATA/MOTION/AVATAR/empty_run_m1.ZMO")));
@@ -1198,12 +2071,13 @@ void FBrettPlugin::StartButton_Clicked()
 
 	/*
 	Zsc meshsc(*(RoseBasePath + TEXT("3DDATA/JUNON/LIST_CNST_JDT.ZSC")));
+	ImportSession session;
 	
 	// Static
-	ImportWorldZscModel("JDTC", meshsc, 12);
+	ImportWorldZscModel(session, "JDTC", meshsc, 12);
 
 	// Animated
-	ImportWorldZscModel("JDTC", meshsc, 8);
+	ImportWorldZscModel(session, "JDTC", meshsc, 8);
 	
 	FQuat rot = FQuat::Identity;
 	FVector pos = FVector(0, 0, 0);
@@ -1219,23 +2093,89 @@ void FBrettPlugin::StartButton_Clicked()
 	const bool IMPORT_BUILDINGS = true;
 	const bool IMPORT_OBJECTS = true;
 	const bool IMPORT_COLLISIONS = false;
+	const bool IMPORT_REFERENCED_ONLY = true;
+	const bool IMPORT_WHOLE_ZONE = false;
+	// Puts each tile's objects in its own sublevel, loaded only when the
+	// viewer is within TILE_STREAMING_RADIUS tiles of it.
+	const bool SPAWN_TILE_SUBLEVELS = false;
+	// Instances repeated static models per tile instead of spawning an actor
+	// for every placement.
+	const bool INSTANCE_TILE_OBJECTS = false;
+	// Splits the landscape into streaming proxies of this many tiles square,
+	// each with its own heightmaps; 0 keeps a single landscape actor.
+	const int LANDSCAPE_PROXY_TILES = SPAWN_TILE_SUBLEVELS ? 4 : 0;
+	const int TILE_STREAMING_RADIUS = 1;
+	const FString ZoneName = TEXT("JDT01");
+	const FString ZonePath = TEXT("3DDATA/MAPS/JUNON/") + ZoneName + TEXT("/");
+
+	int startX = 31;
+	int startY = 30;
+	int endX = 34;
+	int endY = 33;
+	if (IMPORT_WHOLE_ZONE && !FindZoneTileRange(RoseBasePath + ZonePath, startX, startY, endX, endY)) {
+		UE_LOG(RosePlugin, Warning, TEXT("Found no tiles in %s"), *ZonePath);
+		GWarn->EndSlowTask();
+		return;
+	}
+	int tilesX = endX - startX + 1;
+	int tilesY = endY - startY + 1;
+	UE_LOG(RosePlugin, Log, TEXT("Importing tiles %d_%d to %d_%d"), startX, startY, endX, endY);
+
+	// The IFOs for the whole range decode on the worker pool up front, so the
+	// model imports below can be limited to what the tiles place. They are
+	// small next to the actors spawned from them, so they are kept for that.
+	TIndirectArray<FAsyncTask<LoadTileTask>> ifoLoads;
+	for (int iy = startY; iy <= endY; ++iy) {
+		for (int ix = startX; ix <= endX; ++ix) {
+			FString TilePath = FString::Printf(TEXT("%d_%d"), ix, iy);
+			auto ifoLoad = new FAsyncTask<LoadTileTask>(RoseBasePath + ZonePath + TilePath, (uint32)LoadTileTask::LoadIfo);
+			ifoLoads.Add(ifoLoad);
+			ifoLoad->StartBackgroundTask();
+		}
+	}
+
+	TSet<uint32> usedBuildings;
+	TSet<uint32> usedObjects;
+	for (int32 t = 0; t < ifoLoads.Num(); ++t) {
+		ifoLoads[t].EnsureCompletion();
+		const Ifo* ifoData = ifoLoads[t].GetTask().ifoData.GetOwnedPointer();
+		if (!ifoData) {
+			continue;
+		}
+
+		for (int32 i = 0; i < ifoData->Buildings.Num(); ++i) {
+			usedBuildings.Add(ifoData->Buildings[i].ObjectID);
+		}
+		for (int32 i = 0; i < ifoData->Objects.Num(); ++i) {
+			usedObjects.Add(ifoData->Objects[i].ObjectID);
+		}
+	}
 
+	ImportSession session;
 	if (IMPORT_BUILDINGS) {
-		Zsc meshsc(*(RoseBasePath + TEXT("3DDATA/JUNON/LIST_CNST_JDT.ZSC")));
+		Zsc meshsc(*(RoseBasePath + TEXT("3DDATA/JUNON/LIST_CNST_JDT.ZSC")), true);
+		int32 importCount = 0;
 		for (int32 i = 0; i < meshsc.models.Num(); ++i) {
-			if (meshsc.models[i].parts.Num() > 0) {
-				ImportWorldZscModel("JDTC", meshsc, i);
+			if (meshsc.models.partCount(i) > 0 && (!IMPORT_REFERENCED_ONLY || usedBuildings.Contains(i))) {
+				ImportWorldZscModel(session, "JDTC", meshsc, i);
+				importCount++;
 			}
 		}
+		UE_LOG(RosePlugin, Log, TEXT("Imported %d of %d building models"), importCount, meshsc.models.Num());
 	}
 	if (IMPORT_OBJECTS) {
-		Zsc meshsd(*(RoseBasePath + TEXT("3DDATA/JUNON/LIST_DECO_JDT.ZSC")));
+		Zsc meshsd(*(RoseBasePath + TEXT("3DDATA/JUNON/LIST_DECO_JDT.ZSC")), true);
+		int32 importCount = 0;
 		for (int32 i = 0; i < meshsd.models.Num(); ++i) {
-			if (meshsd.models[i].parts.Num() > 0) {
-				ImportWorldZscModel("JDTD", meshsd, i);
+			if (meshsd.models.partCount(i) > 0 && (!IMPORT_REFERENCED_ONLY || usedObjects.Contains(i))) {
+				ImportWorldZscModel(session, "JDTD", meshsd, i);
+				importCount++;
 			}
 		}
+		UE_LOG(RosePlugin, Log, TEXT("Imported %d of %d object models"), importCount, meshsd.models.Num());
 	}
+	session.finishMaterials();
+	session.finishMeshes();
 
 
 	/*
@@ -1270,139 +2210,21 @@ void FBrettPlugin::StartButton_Clicked()
 	const float UEL_ZSCALE = (UEL_HEIGHT_WMAX - UEL_HEIGHT_WMIN) / (HIM_HEIGHT_MAX - HIM_HEIGHT_MIN);
 
 
-	int startX = 31;
-	int startY = 30;
-	int endX = 34;
-	int endY = 33;
-
-	uint32 RoseSizeX = 4 * 16 * (endX - startX + 1);
-	uint32 RoseSizeY = 4 * 16 * (endY - startY + 1);
-	uint32 SizeX = (RoseSizeX / 63 + 1) * 63 + 1;
-	uint32 SizeY = (RoseSizeY / 63 + 1) * 63 + 1;
-	uint32 TileSizeX = SizeX;
-	uint32 TileSizeY = SizeY;
-
-	TArray<uint16> Data;
-	Data.AddZeroed(SizeX * SizeY);
-	for (int i = 0; i < Data.Num(); ++i) {
-		Data[i] = 0x8000;
-	}
-
-	TArray<uint8> WeightData[8];
-	for (int32 i = 0; i < 8; ++i) {
-		WeightData[i].AddZeroed(TileSizeX*TileSizeY);
-	}
-
-	float MinHeight = +1000000;
-	float MaxHeight = -1000000;
-	for (int iy = startY; iy <= endY; ++iy) {
-		for (int ix = startX; ix <= endX; ++ix) {
-			int outTileX = (ix - startX) * 16;
-			int outTileY = (iy - startY) * 16;
-			int outBaseX = (ix - startX) * 64;
-			int outBaseY = (iy - startY) * 64;
-
-			FString TilPath = FString::Printf(TEXT("3DDATA/MAPS/JUNON/JDT01/%d_%d.til"), ix, iy);
-			Til tilData(*(RoseBasePath + TilPath));
-
-			for (int32 sy = 0; sy < 16; ++sy) {
-				for (int32 sx = 0; sx < 16; ++sx) {
-					int32 BrushIdx = tilData.Data[sy * 16 + sx].Brush;
-					check(BrushIdx >= 0 && BrushIdx < 8);
-
-					for (int32 py = 0; py < 5; ++py) {
-						for (int32 px = 0; px < 5; ++px) {
-							int32 PixelX = (outTileX + sx) * 4 + px;
-							int32 PixelY = (outTileY + sy) * 4 + py;
-
-							WeightData[BrushIdx][PixelY * TileSizeX + PixelX] = 50;
-						}
-					}
-				}
-			}
-
-			FString HimPath = FString::Printf(TEXT("3DDATA/MAPS/JUNON/JDT01/%d_%d.him"), ix, iy);
-			Him himData(*(RoseBasePath + HimPath));
-
-			for (int sy = 0; sy < 65; ++sy) {
-				for (int sx = 0; sx < 65; ++sx) {
-					int outIdx = (outBaseY + sy) * SizeX + (outBaseX + sx);
-					float hmValue = himData.heights[sy * 65 + sx];
-					float ueValue = FMath::Clamp(hmValue + 25600.0f, 0.0f, 51200.0f) / 51200.0f * 65535.0f;
-					
-					Data[outIdx] = ueValue;
-
-					if (hmValue < MinHeight) {
-						MinHeight = hmValue;
-					}
-					if (hmValue > MaxHeight) {
-						MaxHeight = hmValue;
-					}
-				}
-			}
+	uint32 RoseSizeX = 4 * 16 * tilesX;
+	uint32 RoseSizeY = 4 * 16 * tilesY;
+	LandscapeLayout Layout = ChooseLandscapeLayout(RoseSizeX, RoseSizeY);
+	uint32 SizeX = Layout.SizeX;
+	uint32 SizeY = Layout.SizeY;
+	const int32 ComponentSizeQuads = Layout.ComponentSizeQuads;
+	const int32 ComponentsX = Layout.ComponentsX;
+	const int32 ComponentsY = Layout.ComponentsY;
 
-
-			FString IfoPath = FString::Printf(TEXT("3DDATA/MAPS/JUNON/JDT01/%d_%d.ifo"), ix, iy);
-			Ifo ifoData(*(RoseBasePath + IfoPath));
-
-			if (IMPORT_BUILDINGS) {
-				for (int32 i = 0; i < ifoData.Buildings.Num(); ++i) {
-					const Ifo::FBuildingBlock& obj = ifoData.Buildings[i];
-					FString ObjName = FString::Printf(TEXT("Bldg_%d_%d_%d"), ix, iy, i);
-					FString AssetName = FString::Printf(TEXT("JDTC_%d"), obj.ObjectID);
-					AActor* ObjActor = SpawnWorldModel(ObjName, CnstPackageName, AssetName, obj.Rotation, obj.Position, obj.Scale);
-				}
-			}
-			if (IMPORT_OBJECTS) {
-				for (int32 i = 0; i < ifoData.Objects.Num(); ++i) {
-					const Ifo::FObjectBlock& obj = ifoData.Objects[i];
-					FString ObjName = FString::Printf(TEXT("Deco_%d_%d_%d"), ix, iy, i);
-					FString AssetName = FString::Printf(TEXT("JDTD_%d"), obj.ObjectID);
-					AActor* ObjActor = SpawnWorldModel(ObjName, CnstPackageName, AssetName, obj.Rotation, obj.Position, obj.Scale);
-					if (ObjActor) {
-						ObjActor->SetActorScale3D(obj.Scale);
-					}
-					
-				}
-			}
-			if (IMPORT_COLLISIONS) {
-				for (int32 i = 0; i < ifoData.Collisions.Num(); ++i) {
-					const Ifo::FCollisionBlock& obj = ifoData.Collisions[i];
-
-					FVector ColSize(120.0f * obj.Scale.X, 6.8f * obj.Scale.Y, 252.2f * obj.Scale.Z);
-					FVector RecenterPos =
-						FRotationTranslationMatrix(FRotator(obj.Rotation), FVector::ZeroVector)
-						.TransformPosition(FVector(0, 0, -ColSize.Z / 2));
-
-					FActorSpawnParameters SpawnInfo;
-					SpawnInfo.Name = *FString::Printf(TEXT("Collision_%d_%d_%d"), ix, iy, i);
-					ABlockingVolume* ObjColl = GWorld->SpawnActor<ABlockingVolume>(
-						obj.Position - RecenterPos, FRotator(obj.Rotation), SpawnInfo);
-
-					if (ObjColl) {
-						UCubeBuilder* Builder = ConstructObject<UCubeBuilder>(UCubeBuilder::StaticClass());
-						Builder->X = ColSize.X;
-						Builder->Y = ColSize.Y;
-						Builder->Z = ColSize.Z;
-						CreateBrushForVolumeActor(ObjColl, Builder);
-
-						ObjColl->BrushComponent->BuildSimpleBrushCollision();
-						if (ObjColl->BrushComponent->IsPhysicsStateCreated()) {
-							ObjColl->BrushComponent->RecreatePhysicsState();
-						}
-
-						ObjColl->BrushComponent->SetCollisionResponseToAllChannels(ECR_Block);
-						ObjColl->BrushComponent->SetCollisionResponseToChannel(ECC_Visibility, ECR_Ignore);
-						ObjColl->BrushComponent->SetCollisionResponseToChannel(ECC_Camera, ECR_Ignore);
-					}
-				}
-			}
-		}
-	}
-
-	UE_LOG(RosePlugin, Log, TEXT("Imported map height bounds were: %f, %f"), MinHeight, MaxHeight);
-
-	
+	// One draw call per component and pass; heightmaps are 4 bytes a vertex plus a third for mips.
+	int32 ComponentVerts = (Layout.SubsectionSizeQuads + 1) * Layout.NumSubsections;
+	int64 HeightmapBytes = (int64)ComponentsX * ComponentsY * ComponentVerts * ComponentVerts * 4 * 4 / 3;
+	UE_LOG(RosePlugin, Log, TEXT("Landscape layout: %dx%d components of %dx%d %d-quad sections, %dx%d vertices for %dx%d of map data, ~%d draw calls, ~%d KB of heightmaps"),
+		ComponentsX, ComponentsY, Layout.NumSubsections, Layout.NumSubsections, Layout.SubsectionSizeQuads,
+		SizeX, SizeY, RoseSizeX + 1, RoseSizeY + 1, ComponentsX * ComponentsY, (int32)(HeightmapBytes / 1024));
 
 	FVector Location = FVector(0, 0, 0);
 	FRotator Rotation = FRotator(0, 0, 0);
@@ -1415,10 +2237,29 @@ void FBrettPlugin::StartButton_Clicked()
 	Landscape->LandscapeMaterial = LMaterial;
 
 	TArray<FLandscapeImportLayerInfo> LayerInfos;
+	TArray<int32> LayerBrushes;
 	auto LayerNames = Landscape->GetLayersFromMaterial();
 	for (int32 i = 0; i < LayerNames.Num(); ++i) {
 		const FName& LayerName = LayerNames[i];
 
+		int32 BrushIdx;
+		if (LayerName.Compare(TEXT("Dirt")) == 0) {
+			BrushIdx = 0;
+			UE_LOG(RosePlugin, Log, TEXT("Found Dirt Layer!"));
+		} else if (LayerName.Compare(TEXT("Grass1")) == 0) {
+			BrushIdx = 1;
+			UE_LOG(RosePlugin, Log, TEXT("Found Grass1 Layer!"));
+		} else if (LayerName.Compare(TEXT("Grass2")) == 0) {
+			BrushIdx = 3;
+			UE_LOG(RosePlugin, Log, TEXT("Found Grass2 Layer!"));
+		} else if (LayerName.Compare(TEXT("Rock")) == 0) {
+			BrushIdx = 5;
+			UE_LOG(RosePlugin, Log, TEXT("Found Rock Layer!"));
+		} else {
+			BrushIdx = 7;
+			UE_LOG(RosePlugin, Log, TEXT("Found Unknown Layer (%s)!"), *(LayerName.ToString()));
+		}
+
 		FString LIPackageName = TEXT("/Layers");
 		FString LayerObjectName = FString::Printf(TEXT("LayerInfo_%d"), i);
 
@@ -1433,34 +2274,67 @@ void FBrettPlugin::StartButton_Clicked()
 		// Mark the package dirty...
 		LIPackage->MarkPackageDirty();
 
+		// The weights are streamed in per region below, so the layer is
+		// registered here without any import data.
 		FLandscapeImportLayerInfo LayerInfo;
-		if (LayerName.Compare(TEXT("Dirt")) == 0) {
-			LayerInfo.LayerData = WeightData[0];
-			UE_LOG(RosePlugin, Log, TEXT("Found Dirt Layer!"));
-		} else if (LayerName.Compare(TEXT("Grass1")) == 0) {
-			LayerInfo.LayerData = WeightData[1];
-			UE_LOG(RosePlugin, Log, TEXT("Found Grass1 Layer!"));
-		} else if (LayerName.Compare(TEXT("Grass2")) == 0) {
-			LayerInfo.LayerData = WeightData[3];
-			UE_LOG(RosePlugin, Log, TEXT("Found Grass2 Layer!"));
-		} else if (LayerName.Compare(TEXT("Rock")) == 0) {
-			LayerInfo.LayerData = WeightData[5];
-			UE_LOG(RosePlugin, Log, TEXT("Found Rock Layer!"));
-		} else {
-			LayerInfo.LayerData = WeightData[7];
-			UE_LOG(RosePlugin, Log, TEXT("Found Unknown Layer (%s)!"), *(LayerName.ToString()));
-		}
 		LayerInfo.LayerName = LayerName;
 		LayerInfo.LayerInfo = LIData;
 		LayerInfos.Add(LayerInfo);
+		LayerBrushes.Add(BrushIdx);
 	}
 
-	Landscape->Import(FGuid::NewGuid(), SizeX, SizeY, 63, 1,  63, Data.GetData(), NULL, LayerInfos);
 	Landscape->StaticLightingLOD = FMath::DivideAndRoundUp(FMath::CeilLogTwo((SizeX * SizeY) / (2048 * 2048) + 1), (uint32)2);
 
 	Landscape->SetActorLocation(FVector((startX - 32) * 16000 - 8000, (startY - 32) * 16000 - 8000, 0));
 	Landscape->StaticLightingResolution = 4.0f;
 
+	// With LANDSCAPE_PROXY_TILES set, the components are split into one
+	// streaming proxy per block of that many tiles square, all sharing the
+	// landscape's GUID and material. With SPAWN_TILE_SUBLEVELS also set, each
+	// proxy goes in its own sublevel so the terrain streams with the camera
+	// like the tile objects do; otherwise the proxies stay in the persistent
+	// level. A component belongs to the block holding its first vertex.
+	TMap<FIntPoint, ALandscapeProxy*> LandscapeProxies;
+	TArray<ULevel*> TileSublevels;
+	auto ProxyFor = [&](int32 cx, int32 cy) -> ALandscapeProxy* {
+		if (LANDSCAPE_PROXY_TILES <= 0) {
+			return Landscape;
+		}
+
+		FIntPoint Block(cx * ComponentSizeQuads / 64 / LANDSCAPE_PROXY_TILES, cy * ComponentSizeQuads / 64 / LANDSCAPE_PROXY_TILES);
+		ALandscapeProxy** Found = LandscapeProxies.Find(Block);
+		if (Found) {
+			return *Found;
+		}
+
+		int BlockX = startX + Block.X * LANDSCAPE_PROXY_TILES;
+		int BlockY = startY + Block.Y * LANDSCAPE_PROXY_TILES;
+		ULevel* BlockLevel = NULL;
+		if (SPAWN_TILE_SUBLEVELS) {
+			BlockLevel = CreateTileSublevel(FString::Printf(TEXT("%s_Landscape_%d_%d"), *ZoneName, BlockX, BlockY),
+				BlockX, BlockY, LANDSCAPE_PROXY_TILES, TILE_STREAMING_RADIUS);
+			if (BlockLevel) {
+				TileSublevels.Add(BlockLevel);
+			}
+		}
+
+		FActorSpawnParameters SpawnInfo;
+		SpawnInfo.Name = *FString::Printf(TEXT("Landscape_%d_%d"), BlockX, BlockY);
+		SpawnInfo.OverrideLevel = BlockLevel;
+		ALandscapeStreamingProxy* Proxy = GWorld->SpawnActor<ALandscapeStreamingProxy>(Landscape->GetActorLocation(), FRotator(0, 0, 0), SpawnInfo);
+		Proxy->GetSharedProperties(Landscape);
+		Proxy->LandscapeActor = Landscape;
+		Proxy->SetActorScale3D(Landscape->GetActorScale3D());
+		LandscapeProxies.Add(Block, Proxy);
+		return Proxy;
+	};
+
+	// The components are created flat; heights and weights are streamed in below.
+	CreateLandscapeComponents(Landscape, Layout, ProxyFor);
+	if (LandscapeProxies.Num() > 0) {
+		UE_LOG(RosePlugin, Log, TEXT("Split the landscape into %d streaming proxies"), LandscapeProxies.Num());
+	}
+
 	ULandscapeInfo* LandscapeInfo = Landscape->GetLandscapeInfo(true);
 	LandscapeInfo->UpdateLayerInfoMap(Landscape);
 	
@@ -1478,12 +2352,158 @@ void FBrettPlugin::StartButton_Clicked()
 			}
 		}
 	}
+
+	// Tiles are loaded, rasterised and written REGION_TILES square at a time,
+	// so peak memory depends on the region size and not on the zone size.
+	const int REGION_TILES = 4;
+	FLandscapeEditDataInterface LandscapeEdit(LandscapeInfo);
+	int32 ComponentLayerCount = 0;
+	float MinHeight = +1000000;
+	float MaxHeight = -1000000;
+	WorldModelSpawner Spawner;
+	ModelInstancer Instancer;
+	for (int ry = startY; ry <= endY; ry += REGION_TILES) {
+		for (int rx = startX; rx <= endX; rx += REGION_TILES) {
+			int rEndX = FMath::Min(rx + REGION_TILES - 1, endX);
+			int rEndY = FMath::Min(ry + REGION_TILES - 1, endY);
+			int rTilesX = rEndX - rx + 1;
+			int rTilesY = rEndY - ry + 1;
+
+			// The TILs of the tiles just before the region are loaded too, since
+			// their cells touch its first row and column.
+			TIndirectArray<FAsyncTask<LoadTileTask>> tileLoads;
+			for (int iy = ry - 1; iy <= rEndY; ++iy) {
+				for (int ix = rx - 1; ix <= rEndX; ++ix) {
+					uint32 Files = LoadTileTask::LoadTil | LoadTileTask::LoadHim;
+					if (ix < startX || iy < startY) {
+						Files = 0;
+					} else if (ix < rx || iy < ry) {
+						Files = LoadTileTask::LoadTil;
+					}
+
+					FString TilePath = FString::Printf(TEXT("%d_%d"), ix, iy);
+					auto tileLoad = new FAsyncTask<LoadTileTask>(RoseBasePath + ZonePath + TilePath, Files);
+					tileLoads.Add(tileLoad);
+					tileLoad->StartBackgroundTask();
+				}
+			}
+			auto tileLoad = [&](int ix, int iy) -> LoadTileTask& {
+				return tileLoads[(iy - ry + 1) * (rTilesX + 1) + (ix - rx + 1)].GetTask();
+			};
+
+			// Only brushes some tile touching the region paints get a weight layer.
+			bool BrushUsed[8] = { false };
+			for (int32 t = 0; t < tileLoads.Num(); ++t) {
+				tileLoads[t].EnsureCompletion();
+				const Til* tilData = tileLoads[t].GetTask().tilData.GetOwnedPointer();
+				if (!tilData) {
+					continue;
+				}
+
+				for (int32 i = 0; i < tilData->Data.Num(); ++i) {
+					check(tilData->Data[i].Brush < 8);
+					BrushUsed[tilData->Data[i].Brush] = true;
+				}
+			}
+
+			int32 RegionSizeX = rTilesX * 64 + 1;
+			int32 RegionSizeY = rTilesY * 64 + 1;
+			TArray<uint16> Data;
+			Data.Init(0x8000, RegionSizeX * RegionSizeY);
+
+			TArray<uint8> WeightData[8];
+			for (int32 i = 0; i < 8; ++i) {
+				if (BrushUsed[i]) {
+					WeightData[i].AddZeroed(RegionSizeX * RegionSizeY);
+				}
+			}
+
+			// The region's last tiles write their far edge too; the next region
+			// overwrites it with the same heights and its complete splat weights.
+			TIndirectArray<FAsyncTask<RasterTileTask>> tileRasters;
+			for (int iy = ry; iy <= rEndY; ++iy) {
+				for (int ix = rx; ix <= rEndX; ++ix) {
+					auto tileRaster = new FAsyncTask<RasterTileTask>();
+					RasterTileTask& task = tileRaster->GetTask();
+					task.neighbourTils[0][0] = tileLoad(ix - 1, iy - 1).tilData.GetOwnedPointer();
+					task.neighbourTils[0][1] = tileLoad(ix, iy - 1).tilData.GetOwnedPointer();
+					task.neighbourTils[1][0] = tileLoad(ix - 1, iy).tilData.GetOwnedPointer();
+					task.neighbourTils[1][1] = tileLoad(ix, iy).tilData.GetOwnedPointer();
+					task.himData = tileLoad(ix, iy).himData.GetOwnedPointer();
+					task.lastX = ix == rEndX;
+					task.lastY = iy == rEndY;
+					task.baseX = (ix - rx) * 64;
+					task.baseY = (iy - ry) * 64;
+					task.pitch = RegionSizeX;
+					task.heightData = Data.GetData();
+					for (int32 i = 0; i < 8; ++i) {
+						task.weightData[i] = BrushUsed[i] ? WeightData[i].GetData() : nullptr;
+					}
+					tileRasters.Add(tileRaster);
+					tileRaster->StartBackgroundTask();
+				}
+			}
+
+			for (int32 t = 0; t < tileRasters.Num(); ++t) {
+				tileRasters[t].EnsureCompletion();
+				MinHeight = FMath::Min(MinHeight, tileRasters[t].GetTask().minHeight);
+				MaxHeight = FMath::Max(MaxHeight, tileRasters[t].GetTask().maxHeight);
+			}
+
+			int32 RegionX = (rx - startX) * 64;
+			int32 RegionY = (ry - startY) * 64;
+			LandscapeEdit.SetHeightData(RegionX, RegionY, RegionX + RegionSizeX - 1, RegionY + RegionSizeY - 1, Data.GetData(), RegionSizeX, true);
+			ComponentLayerCount += WriteComponentWeights(LandscapeEdit, LayerInfos, LayerBrushes, WeightData, RegionX, RegionY, RegionSizeX, RegionSizeY, ComponentSizeQuads);
+
+			// Spawning has to stay on the game thread, so it follows the region's writes.
+			for (int iy = ry; iy <= rEndY; ++iy) {
+				for (int ix = rx; ix <= rEndX; ++ix) {
+					const Ifo* ifoData = ifoLoads[(iy - startY) * tilesX + (ix - startX)].GetTask().ifoData.GetOwnedPointer();
+					if (ifoData) {
+						bool SpawnsAnything =
+							(IMPORT_BUILDINGS && ifoData->Buildings.Num() > 0) ||
+							(IMPORT_OBJECTS && ifoData->Objects.Num() > 0) ||
+							(IMPORT_COLLISIONS && ifoData->Collisions.Num() > 0);
+						ULevel* TileLevel = NULL;
+						if (SPAWN_TILE_SUBLEVELS && SpawnsAnything) {
+							TileLevel = CreateTileSublevel(FString::Printf(TEXT("%s_%d_%d"), *ZoneName, ix, iy), ix, iy, 1, TILE_STREAMING_RADIUS);
+							if (TileLevel) {
+								TileSublevels.Add(TileLevel);
+							}
+						}
+						SpawnTileObjects(CnstPackageName, *ifoData, ix, iy, IMPORT_BUILDINGS, IMPORT_OBJECTS, IMPORT_COLLISIONS,
+							Spawner, TileLevel, INSTANCE_TILE_OBJECTS ? &Instancer : NULL);
+					}
+				}
+			}
+		}
+	}
+	LandscapeEdit.Flush();
+	Spawner.Finish();
+
+	UE_LOG(RosePlugin, Log, TEXT("Imported map height bounds were: %f, %f"), MinHeight, MaxHeight);
+	UE_LOG(RosePlugin, Log, TEXT("Wrote %d weight layers across %d landscape components"), ComponentLayerCount, ComponentsX * ComponentsY);
+	session.logAssetStats();
 	
 	Landscape->PostEditChange();
 
 	for (auto Component : Landscape->LandscapeComponents) {
 		Component->UpdateMaterialInstances();
 	}
+	for (auto It = LandscapeProxies.CreateConstIterator(); It; ++It) {
+		It.Value()->PostEditChange();
+		for (auto Component : It.Value()->LandscapeComponents) {
+			Component->UpdateMaterialInstances();
+		}
+	}
+
+	// The sublevels were written out while still empty, so they are saved
+	// again now that their actors and terrain are done.
+	for (int32 i = 0; i < TileSublevels.Num(); ++i) {
+		if (!FEditorFileUtils::SaveLevel(TileSublevels[i])) {
+			UE_LOG(RosePlugin, Warning, TEXT("Failed to save sublevel %s"), *TileSublevels[i]->GetOutermost()->GetName());
+		}
+	}
 
 	//*/
 
@@ -1502,6 +2522,7 @@ void FBrettPlugin::StartButton_Clicked()
 
 	/*
 	std::vector<int> charsToIgnore = { };
+	ImportSession session;
 	for (int i = 0; i < std::min(400, chars.characters.Num()); ++i) {
 		if (std::find(charsToIgnore.begin(), charsToIgnore.end(), i) != charsToIgnore.end()) {
 			continue;
@@ -1509,7 +2530,8 @@ void FBrettPlugin::StartButton_Clicked()
 
 		const Chr::Character& tchar = chars.characters[i];
 		if (tchar.enabled && tchar.models.Num() > 0) {
-			ImportChar(chars, meshs, i);
+			ImportChar(session, chars, meshs, i);
+			session.reset();
 		}
 	}
 	//*/
@@ -1520,8 +2542,10 @@ void FBrettPlugin::StartButton_Clicked()
 
 	int charsToImport[] = { 396, 0 };
 	int* charNext = charsToImport;
+	ImportSession session;
 	while (*charNext != 0) {
-		ImportChar(chars, meshs, *charNext++);
+		ImportChar(session, chars, meshs, *charNext++);
+		session.reset();
 	}
 	//*/
 
@@ -1761,7 +2785,7 @@ void FBrettPlugin::StartButton_Clicked()
 
 	
 	ReadHelper rh;
-	FFileHelper::LoadFileToArray(rh.data, TEXT("D:/zz_test_evo/3DDATA/NPC/NPC/CHIEF/BODY01.ZMS"));
+	rh.open(TEXT("D:/zz_test_evo/3DDATA/NPC/NPC/CHIEF/BODY01.ZMS"));
  
 
 
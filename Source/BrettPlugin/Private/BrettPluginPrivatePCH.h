@@ -46,5 +46,13 @@
 #include "Runtime/Engine/Classes/Landscape/LandscapeLayerInfoObject.h"
 #include "Editor/LandscapeEditor/Public/LandscapeEdMode.h"
 #include "Runtime/Engine/Classes/Landscape/LandscapeComponent.h"
+#include "Runtime/Engine/Classes/Landscape/LandscapeStreamingProxy.h"
+#include "LandscapeEdit.h"
+#include "EditorLevelUtils.h"
+#include "FileHelpers.h"
+#include "LevelUtils.h"
+#include "Engine/LevelStreamingKismet.h"
+#include "Engine/LevelStreamingVolume.h"
+#include "Components/InstancedStaticMeshComponent.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(RosePlugin, Log, All);
@@ -26,7 +26,8 @@ public:
     };
 
     Chr(const TCHAR *Filename) {
-        FFileHelper::LoadFileToArray(rh.data, Filename);
+        ReadHelper rh;
+        rh.open(Filename);
 
         auto skeletonCount = rh.read<uint16>();
         for (uint16 i = 0; i < skeletonCount; ++i) {
@@ -82,7 +83,4 @@ public:
     TArray<FString> animations;
     TArray<FString> effects;
     TArray<Character> characters;
-
-private:
-    ReadHelper rh;
 };
\ No newline at end of file
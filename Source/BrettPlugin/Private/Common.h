@@ -2,31 +2,128 @@
 
 #include "BrettPluginPrivatePCH.h"
 
-class ReadHelper {
+#if PLATFORM_WINDOWS
+#include "AllowWindowsPlatformTypes.h"
+#include <windows.h>
+#include "HideWindowsPlatformTypes.h"
+#elif PLATFORM_MAC || PLATFORM_LINUX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ROSE stores quaternions with W first.
+struct FBadQuat {
+	float W, X, Y, Z;
+
+	FQuat ToQuat() const {
+		return FQuat(X, Y, Z, W);
+	}
+};
+
+// A non-owning view of a run of elements stored elsewhere.
+template<typename T> struct Span {
+	Span() : data(nullptr), num(0) {
+	}
+
+	Span(T *_data, int32 _num) : data(_data), num(_num) {
+	}
+
+	int32 Num() const {
+		return num;
+	}
+
+	T* GetData() const {
+		return data;
+	}
+
+	T& operator[](int32 i) const {
+		checkSlow(i >= 0 && i < num);
+		return data[i];
+	}
+
+	T *data;
+	int32 num;
+};
+
+// Interns a ROSE file path as an upper-case, forward-slashed FName, so
+// repeated paths share one handle and compare without string work.
+FName internPath(const char *path) {
+	char Buffer[NAME_SIZE];
+	int32 i = 0;
+	for (; path[i] != 0 && i < NAME_SIZE - 1; ++i) {
+		char c = path[i];
+		Buffer[i] = (c == '\\') ? '/' : (char)toupper((unsigned char)c);
+	}
+	Buffer[i] = 0;
+	return FName(Buffer);
+}
+
+class ReadHelper : public FNoncopyable {
 public:
-	ReadHelper() : pos(0) {
+	ReadHelper() : pos(0), base(nullptr), fileSize(0), mapped(false) {
+	}
+
+	~ReadHelper() {
+		close();
+	}
+
+	// Maps the file read-only so reads come straight out of the page cache,
+	// falling back to loading it onto the heap when it can't be mapped.
+	bool open(const TCHAR *Filename) {
+		close();
+		if (map(Filename)) {
+			return true;
+		}
+
+		if (!FFileHelper::LoadFileToArray(data, Filename)) {
+			return false;
+		}
+		base = data.GetData();
+		fileSize = data.Num();
+		return true;
+	}
+
+	void close() {
+		if (mapped) {
+#if PLATFORM_WINDOWS
+			UnmapViewOfFile(base);
+#elif PLATFORM_MAC || PLATFORM_LINUX
+			munmap((void*)base, fileSize);
+#endif
+			mapped = false;
+		}
+		data.Empty();
+		base = nullptr;
+		fileSize = 0;
+		pos = 0;
+	}
+
+	bool isMapped() const {
+		return mapped;
 	}
 
 	template<typename T> const T& read() {
 		pos += sizeof(T);
-		return *(T*)&data[pos - sizeof(T)];
+		return *(const T*)&base[pos - sizeof(T)];
 	}
 
 	const char* read(int size) {
-		auto out = (char*)&data[pos];
+		auto out = (const char*)&base[pos];
 		pos += size;
 		return out;
 	}
 
 	const char* readStr() {
-		auto out = (char*)&data[pos];
+		auto out = (const char*)&base[pos];
 		pos += strlen(out) + 1;
 		return out;
 	}
 
 	FString readStr(int32 len) {
 		char TempBuffer[256];
-		memcpy(TempBuffer, &data[pos], len);
+		memcpy(TempBuffer, &base[pos], len);
 		TempBuffer[len] = 0;
 		pos += len;
 		return TempBuffer;
@@ -42,9 +139,48 @@ public:
 	}
 
 	FQuat readBadQuat() {
-		struct FBadQuat { float W, X, Y, Z; };
-		auto q = read<FBadQuat>();
-		return FQuat(q.X, q.Y, q.Z, q.W);
+		return read<FBadQuat>().ToQuat();
+	}
+
+	// Copies a packed block of `count` elements in one go.
+	template<typename T> void readArray(T *out, int32 count) {
+		FMemory::Memcpy(out, read(sizeof(T) * count), sizeof(T) * count);
+	}
+
+	template<typename T> void readArray(TArray<T>& out, int32 count) {
+		out.Empty(count);
+		out.AddUninitialized(count);
+		readArray(out.GetData(), count);
+	}
+
+	// Reads a packed block of `count` TIn elements and stores op(element) for
+	// each, so conversions happen in the same pass as the copy.
+	template<typename TIn, typename TOut, typename TOp> void readArray(TOut *out, int32 count, TOp op) {
+		auto in = (const TIn*)read(sizeof(TIn) * count);
+		for (int32 i = 0; i < count; ++i) {
+			out[i] = op(in[i]);
+		}
+	}
+
+	template<typename TIn, typename TOut, typename TOp> void readArray(TArray<TOut>& out, int32 count, TOp op) {
+		out.Empty(count);
+		out.AddUninitialized(count);
+		readArray<TIn>(out.GetData(), count, op);
+	}
+
+	// Gathers `count` TIn elements spaced `stride` bytes apart starting at
+	// `offset`, for streams interleaved with others. Does not move the position.
+	template<typename TIn, typename TOut, typename TOp> void readStrided(TOut *out, int32 count, int32 offset, int32 stride, TOp op) const {
+		auto in = &base[offset];
+		for (int32 i = 0; i < count; ++i, in += stride) {
+			out[i] = op(*(const TIn*)in);
+		}
+	}
+
+	template<typename TIn, typename TOut, typename TOp> void readStrided(TArray<TOut>& out, int32 count, int32 offset, int32 stride, TOp op) const {
+		out.Empty(count);
+		out.AddUninitialized(count);
+		readStrided<TIn>(out.GetData(), count, offset, stride, op);
 	}
 
 	int tell() {
@@ -59,7 +195,77 @@ public:
 		pos += num;
 	}
 
+	int32 length() const {
+		return fileSize;
+	}
+
+	const uint8* view() const {
+		return base;
+	}
+
 	int pos;
+
+private:
+	bool map(const TCHAR *Filename) {
+#if PLATFORM_WINDOWS
+		HANDLE File = CreateFileW(Filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (File == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+
+		LARGE_INTEGER FileSize;
+		if (!GetFileSizeEx(File, &FileSize) || FileSize.QuadPart <= 0 || FileSize.QuadPart > MAX_int32) {
+			CloseHandle(File);
+			return false;
+		}
+
+		// The view keeps the mapping alive, so neither handle needs to outlive this call.
+		HANDLE Mapping = CreateFileMappingW(File, NULL, PAGE_READONLY, 0, 0, NULL);
+		CloseHandle(File);
+		if (Mapping == NULL) {
+			return false;
+		}
+
+		void *View = MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(Mapping);
+		if (View == NULL) {
+			return false;
+		}
+
+		base = (const uint8*)View;
+		fileSize = (int32)FileSize.QuadPart;
+		mapped = true;
+		return true;
+#elif PLATFORM_MAC || PLATFORM_LINUX
+		int File = ::open(TCHAR_TO_UTF8(Filename), O_RDONLY);
+		if (File < 0) {
+			return false;
+		}
+
+		struct stat FileStat;
+		if (fstat(File, &FileStat) != 0 || FileStat.st_size <= 0 || FileStat.st_size > MAX_int32) {
+			::close(File);
+			return false;
+		}
+
+		void *View = mmap(NULL, FileStat.st_size, PROT_READ, MAP_PRIVATE, File, 0);
+		::close(File);
+		if (View == MAP_FAILED) {
+			return false;
+		}
+
+		base = (const uint8*)View;
+		fileSize = (int32)FileStat.st_size;
+		mapped = true;
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	const uint8 *base;
+	int32 fileSize;
+	bool mapped;
 	TArray<uint8> data;
 };
 
@@ -74,3 +280,126 @@ FQuat rtuRotation(const FQuat& q) {
 FVector rtuScale(const FVector& v) {
 	return v;
 }
+
+
+// Batch forms of the conversions above for whole attribute and track blocks.
+// The sign flips and scale are single multiplies in both the vector and the
+// scalar paths, so results are bit-identical to the per-element functions.
+// rtuScale is the identity and has no batch form. Checked builds compare
+// every result against the per-element function.
+
+#if DO_CHECK
+// NaNs compare equal here, since a vector multiply by -1 need not give a
+// NaN the same sign bit as the scalar negation.
+bool rtuSameFloats(const float *a, const float *b, int32 count) {
+	for (int32 i = 0; i < count; ++i) {
+		if (a[i] != b[i] && (a[i] == a[i] || b[i] == b[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+#endif
+
+void rtuPositions(FVector *v, int32 count, float scale = 1.0f) {
+#if DO_CHECK
+	TArray<FVector> expected;
+	expected.Empty(count);
+	for (int32 j = 0; j < count; ++j) {
+		expected.Add(rtuPosition(v[j]) * scale);
+	}
+#endif
+
+	int32 i = 0;
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+	// Four packed FVectors span three registers, so the X,-Y,Z pattern repeats every three.
+	const VectorRegister m0 = MakeVectorRegister(scale, -scale, scale, scale);
+	const VectorRegister m1 = MakeVectorRegister(-scale, scale, scale, -scale);
+	const VectorRegister m2 = MakeVectorRegister(scale, scale, -scale, scale);
+	float *f = (float*)v;
+	for (; i + 4 <= count; i += 4, f += 12) {
+		VectorStore(VectorMultiply(VectorLoad(f + 0), m0), f + 0);
+		VectorStore(VectorMultiply(VectorLoad(f + 4), m1), f + 4);
+		VectorStore(VectorMultiply(VectorLoad(f + 8), m2), f + 8);
+	}
+#endif
+	for (; i < count; ++i) {
+		v[i] = rtuPosition(v[i]) * scale;
+	}
+
+#if DO_CHECK
+	check(rtuSameFloats((const float*)v, (const float*)expected.GetData(), count * 3));
+#endif
+}
+
+void rtuRotations(FQuat *q, int32 count) {
+#if DO_CHECK
+	TArray<FQuat> expected;
+	expected.Empty(count);
+	for (int32 j = 0; j < count; ++j) {
+		expected.Add(rtuRotation(q[j]));
+	}
+#endif
+
+	int32 i = 0;
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+	const VectorRegister m = MakeVectorRegister(-1.0f, 1.0f, -1.0f, 1.0f);
+	for (; i < count; ++i) {
+		VectorStore(VectorMultiply(VectorLoad(&q[i]), m), &q[i]);
+	}
+#endif
+	for (; i < count; ++i) {
+		q[i] = rtuRotation(q[i]);
+	}
+
+#if DO_CHECK
+	check(rtuSameFloats((const float*)q, (const float*)expected.GetData(), count * 4));
+#endif
+}
+
+// Maps HIM heights to 16-bit landscape samples with
+// (uint16)(Clamp(h + 25600, 0, 51200) / 51200 * 65535), and widens
+// minHeight/maxHeight over the raw heights in the same pass.
+void quantizeHeights(uint16 *out, const float *in, int32 count, float& minHeight, float& maxHeight) {
+	int32 i = 0;
+#if PLATFORM_ENABLE_VECTORINTRINSICS && (PLATFORM_WINDOWS || PLATFORM_MAC || PLATFORM_LINUX)
+	// The conversion and narrowing have no VectorRegister equivalent, so this uses SSE2 directly.
+	if (count >= 8) {
+		const __m128 offset = _mm_set1_ps(25600.0f);
+		const __m128 range = _mm_set1_ps(51200.0f);
+		const __m128 scale = _mm_set1_ps(65535.0f);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128i bias = _mm_set1_epi32(0x8000);
+		const __m128i flip = _mm_set1_epi16((int16)0x8000);
+		__m128 vmin = _mm_loadu_ps(in);
+		__m128 vmax = vmin;
+		for (; i + 8 <= count; i += 8) {
+			__m128 h0 = _mm_loadu_ps(in + i);
+			__m128 h1 = _mm_loadu_ps(in + i + 4);
+			vmin = _mm_min_ps(vmin, _mm_min_ps(h0, h1));
+			vmax = _mm_max_ps(vmax, _mm_max_ps(h0, h1));
+
+			__m128 q0 = _mm_mul_ps(_mm_div_ps(_mm_min_ps(_mm_max_ps(_mm_add_ps(h0, offset), zero), range), range), scale);
+			__m128 q1 = _mm_mul_ps(_mm_div_ps(_mm_min_ps(_mm_max_ps(_mm_add_ps(h1, offset), zero), range), range), scale);
+
+			// packs saturates as signed, so the values are biased into int16 range and back.
+			__m128i s0 = _mm_sub_epi32(_mm_cvttps_epi32(q0), bias);
+			__m128i s1 = _mm_sub_epi32(_mm_cvttps_epi32(q1), bias);
+			_mm_storeu_si128((__m128i*)(out + i), _mm_xor_si128(_mm_packs_epi32(s0, s1), flip));
+		}
+
+		vmin = _mm_min_ps(vmin, _mm_shuffle_ps(vmin, vmin, _MM_SHUFFLE(1, 0, 3, 2)));
+		vmin = _mm_min_ps(vmin, _mm_shuffle_ps(vmin, vmin, _MM_SHUFFLE(2, 3, 0, 1)));
+		vmax = _mm_max_ps(vmax, _mm_shuffle_ps(vmax, vmax, _MM_SHUFFLE(1, 0, 3, 2)));
+		vmax = _mm_max_ps(vmax, _mm_shuffle_ps(vmax, vmax, _MM_SHUFFLE(2, 3, 0, 1)));
+		minHeight = FMath::Min(minHeight, _mm_cvtss_f32(vmin));
+		maxHeight = FMath::Max(maxHeight, _mm_cvtss_f32(vmax));
+	}
+#endif
+	for (; i < count; ++i) {
+		float h = in[i];
+		out[i] = (uint16)(FMath::Clamp(h + 25600.0f, 0.0f, 51200.0f) / 51200.0f * 65535.0f);
+		minHeight = FMath::Min(minHeight, h);
+		maxHeight = FMath::Max(maxHeight, h);
+	}
+}
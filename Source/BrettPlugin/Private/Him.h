@@ -5,7 +5,8 @@
 class Him {
 public:
     Him(const TCHAR *Filename) {
-        FFileHelper::LoadFileToArray(rh.data, Filename);
+        ReadHelper rh;
+        rh.open(Filename);
 
         auto width = rh.read<uint32>();
         auto height = rh.read<uint32>();
@@ -14,16 +15,20 @@ public:
         
         check(width == 65 && height == 65);
 
-        heights.AddZeroed(width * height);
-        for (uint32 y = 0; y < height; ++y) {
-            for (uint32 x = 0; x < width; ++x) {
-                heights[y*width+x] = rh.read<float>();
-            }
-        }
+        rh.readArray(heightData, width * height);
+        size = width;
     }
 
-    TArray<float> heights;
+    int32 size;
+
+    Span<const float> heights() const {
+        return Span<const float>(heightData.GetData(), heightData.Num());
+    }
+
+    Span<const float> row(int32 y) const {
+        return Span<const float>(heightData.GetData() + y * size, size);
+    }
 
 private:
-    ReadHelper rh;
+    TArray<float> heightData;
 };
\ No newline at end of file
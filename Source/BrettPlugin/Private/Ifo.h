@@ -46,7 +46,8 @@ public:
 	};
 
 	Ifo(const TCHAR *Filename) {
-		FFileHelper::LoadFileToArray(rh.data, Filename);
+		ReadHelper rh;
+		rh.open(Filename);
 
 		auto blockCount = rh.read<uint32>();
 		for (uint32 i = 0; i < blockCount; ++i) {
@@ -59,17 +60,17 @@ public:
 			if (blockType == EBlockType::Object) {
 				uint32 objCount = rh.read<uint32>();
 				for (uint32 j = 0; j < objCount; ++j) {
-					Objects.Add(ReadBaseObject<FObjectBlock>());
+					Objects.Add(ReadBaseObject<FObjectBlock>(rh));
 				}
 			} else if (blockType == EBlockType::Building) {
 				uint32 objCount = rh.read<uint32>();
 				for (uint32 j = 0; j < objCount; ++j) {
-					Buildings.Add(ReadBaseObject<FBuildingBlock>());
+					Buildings.Add(ReadBaseObject<FBuildingBlock>(rh));
 				}
 			} else if (blockType == EBlockType::CollisionObject) {
 				uint32 objCount = rh.read<uint32>();
 				for (uint32 j = 0; j < objCount; ++j) {
-					Collisions.Add(ReadBaseObject<FCollisionBlock>());
+					Collisions.Add(ReadBaseObject<FCollisionBlock>(rh));
 				}
 			}
 
@@ -78,7 +79,7 @@ public:
 	}
 
 	template<typename DerivedBlockType>
-	DerivedBlockType ReadBaseObject() {
+	static DerivedBlockType ReadBaseObject(ReadHelper& rh) {
 		DerivedBlockType data;
 		FMapBlock* obj = &data;
 		obj->Name = rh.readByteStr();
@@ -96,7 +97,4 @@ public:
 	TArray<FBuildingBlock> Buildings;
 	TArray<FObjectBlock> Objects;
 	TArray<FCollisionBlock> Collisions;
-
-private:
-	ReadHelper rh;
 };
\ No newline at end of file
@@ -14,7 +14,8 @@ public:
 #pragma pack(pop)
 
 	Til(const TCHAR *Filename) {
-		FFileHelper::LoadFileToArray(rh.data, Filename);
+		ReadHelper rh;
+		rh.open(Filename);
 
 		Width = rh.read<uint32>();
 		Height = rh.read<uint32>();
@@ -27,7 +28,4 @@ public:
 	uint32 Width;
 	uint32 Height;
 	TArray<FTile> Data;
-
-private:
-	ReadHelper rh;
 };
\ No newline at end of file
@@ -12,7 +12,8 @@ public:
     };
 
     Zmd(const TCHAR *Filename) {
-        FFileHelper::LoadFileToArray(rh.data, Filename);
+        ReadHelper rh;
+        rh.open(Filename);
 
         auto header = rh.read<char[7]>();
         uint32 version = 0;
@@ -47,7 +48,4 @@ public:
 
     TArray<Bone> bones;
     TArray<Bone> dummies;
-
-private:
-    ReadHelper rh;
 };
\ No newline at end of file
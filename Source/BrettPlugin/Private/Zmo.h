@@ -21,26 +21,17 @@ public:
         };
     };
 
+    // Frames for every channel of one type live in a single buffer, channel
+    // after channel; `first` is where this channel's frames start in it.
     struct Channel {
+        ChannelType::Type type;
         uint32 index;
-        virtual ChannelType::Type type() = 0;
-    };
-
-    struct PositionChannel : public Channel {
-        ChannelType::Type type() override { return ChannelType::Position; }
-        TArray<FVector> frames;
-    };
-    struct RotationChannel : public Channel {
-        ChannelType::Type type() override { return ChannelType::Rotation; }
-        TArray<FQuat> frames;
-    };
-    struct ScaleChannel : public Channel {
-        ChannelType::Type type() override { return ChannelType::Scale; }
-        TArray<FVector> frames;
+        int32 first;
     };
 
     Zmo(const TCHAR *Filename) {
-        FFileHelper::LoadFileToArray(rh.data, Filename);
+        ReadHelper rh;
+        rh.open(Filename);
 
         auto header = rh.readStr();
 
@@ -48,48 +39,90 @@ public:
         frameCount = rh.read<uint32>();
         auto channelCount = rh.read<uint32>();
 
+        // Lay out the flat buffers and each channel's offset within a frame record.
+        TArray<int32> recordOffsets;
+        int32 frameStride = 0;
+        int32 positionCount = 0;
+        int32 rotationCount = 0;
+        int32 scaleCount = 0;
+        channels.Empty(channelCount);
         for (uint32 i = 0; i < channelCount; ++i) {
-            Channel * channel = nullptr;
-
-            auto type = rh.read<uint32>();
-            if (type == ChannelType::Position) {
-                channel = new PositionChannel();
-            } else if (type == ChannelType::Rotation) {
-                channel = new RotationChannel();
-            } else if (type == ChannelType::Scale) {
-                channel = new ScaleChannel();
+            Channel channel;
+            channel.type = (ChannelType::Type)rh.read<uint32>();
+            channel.index = rh.read<uint32>();
+            recordOffsets.Add(frameStride);
+
+            if (channel.type == ChannelType::Position) {
+                channel.first = positionCount++ * frameCount;
+                frameStride += sizeof(FVector);
+            } else if (channel.type == ChannelType::Rotation) {
+                channel.first = rotationCount++ * frameCount;
+                frameStride += sizeof(FBadQuat);
+            } else if (channel.type == ChannelType::Scale) {
+                channel.first = scaleCount++ * frameCount;
+                frameStride += sizeof(FVector);
             } else {
+                channel.first = 0;
                 DebugBreak();
             }
 
-            channel->index = rh.read<uint32>();
             channels.Add(channel);
         }
 
-        for (uint32 j = 0; j < frameCount; ++j) {
-            for (uint32 i = 0; i < channelCount; ++i) {
-                Channel *channel = channels[i];
-                if (channel->type() == ChannelType::Position) {
-                    auto& frames = ((PositionChannel*)channel)->frames;
-                    frames.Add(rtuPosition(rh.read<FVector>()));
-                } else if (channel->type() == ChannelType::Rotation) {
-                    auto& frames = ((RotationChannel*)channel)->frames;
-                    //frames.Add(rtuRotation(rh.read<FQuat>()));
-					frames.Add(rtuRotation(rh.readBadQuat()));
-                } else if (channel->type() == ChannelType::Scale) {
-                    auto& frames = ((ScaleChannel*)channel)->frames;
-                    frames.Add(rtuScale(rh.read<FVector>()));
-                } else {
-                    DebugBreak();
-                }
+        positionFrames.Empty(positionCount * frameCount);
+        positionFrames.AddUninitialized(positionCount * frameCount);
+        rotationFrames.Empty(rotationCount * frameCount);
+        rotationFrames.AddUninitialized(rotationCount * frameCount);
+        scaleFrames.Empty(scaleCount * frameCount);
+        scaleFrames.AddUninitialized(scaleCount * frameCount);
+
+        // Frames are stored frame-major; transpose them to channel-major with
+        // one strided gather per channel, then convert each buffer in one go.
+        int32 framesStart = rh.tell();
+        for (int32 i = 0; i < channels.Num(); ++i) {
+            const Channel& channel = channels[i];
+            int32 offset = framesStart + recordOffsets[i];
+            if (channel.type == ChannelType::Position) {
+                rh.readStrided<FVector>(positionFrames.GetData() + channel.first, frameCount, offset, frameStride, [](const FVector& v) {
+                    return v;
+                });
+            } else if (channel.type == ChannelType::Rotation) {
+                rh.readStrided<FBadQuat>(rotationFrames.GetData() + channel.first, frameCount, offset, frameStride, [](const FBadQuat& q) {
+                    return q.ToQuat();
+                });
+            } else if (channel.type == ChannelType::Scale) {
+                rh.readStrided<FVector>(scaleFrames.GetData() + channel.first, frameCount, offset, frameStride, [](const FVector& v) {
+                    return rtuScale(v);
+                });
             }
         }
+        rh.seek(framesStart + frameStride * frameCount);
+
+        rtuPositions(positionFrames.GetData(), positionFrames.Num());
+        rtuRotations(rotationFrames.GetData(), rotationFrames.Num());
+    }
+
+    Span<const FVector> positions(const Channel& channel) const {
+        check(channel.type == ChannelType::Position);
+        return Span<const FVector>(positionFrames.GetData() + channel.first, frameCount);
+    }
+
+    Span<const FQuat> rotations(const Channel& channel) const {
+        check(channel.type == ChannelType::Rotation);
+        return Span<const FQuat>(rotationFrames.GetData() + channel.first, frameCount);
+    }
+
+    Span<const FVector> scales(const Channel& channel) const {
+        check(channel.type == ChannelType::Scale);
+        return Span<const FVector>(scaleFrames.GetData() + channel.first, frameCount);
     }
 
     uint32 framesPerSecond;
     uint32 frameCount;
-    TArray<Channel*> channels;
+    TArray<Channel> channels;
 
 private:
-    ReadHelper rh;
-};
\ No newline at end of file
+    TArray<FVector> positionFrames;
+    TArray<FQuat> rotationFrames;
+    TArray<FVector> scaleFrames;
+};
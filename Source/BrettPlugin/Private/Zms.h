@@ -2,7 +2,7 @@
 
 #include "Common.h"
 
-class Zms {
+class Zms : public FNoncopyable {
 public:
 	enum ZmsFormat {
 		ZMSF_NONE = 1 << 0,
@@ -15,7 +15,12 @@ public:
 		ZMSF_UV1 = 1 << 7,
 		ZMSF_UV2 = 1 << 8,
 		ZMSF_UV3 = 1 << 9,
-		ZMSF_UV4 = 1 << 10
+		ZMSF_UV4 = 1 << 10,
+
+		// Attribute masks for the decoding constructor.
+		ZMSF_SKIN = ZMSF_BLENDWEIGHT | ZMSF_BLENDINDEX,
+		ZMSF_UVS = ZMSF_UV1 | ZMSF_UV2 | ZMSF_UV3 | ZMSF_UV4,
+		ZMSF_ALL = ZMSF_POSITION | ZMSF_NORMAL | ZMSF_COLOR | ZMSF_SKIN | ZMSF_TANGENT | ZMSF_UVS
 	};
 
 	struct BoneWeights {
@@ -23,96 +28,273 @@ public:
 		uint16 boneIdx[4];
 	};
 
-	Zms(const TCHAR *Filename) {
-		FFileHelper::LoadFileToArray(rh.data, Filename);
+	// Attribute sections in file order. Indices follow the face count word.
+	enum ZmsSection {
+		ZMSS_POSITION,
+		ZMSS_NORMAL,
+		ZMSS_COLOR,
+		ZMSS_BONEWEIGHT,
+		ZMSS_TANGENT,
+		ZMSS_UV1,
+		ZMSS_UV2,
+		ZMSS_UV3,
+		ZMSS_UV4,
+		ZMSS_INDEX,
+		ZMSS_COUNT
+	};
 
-		auto header = rh.read<char[8]>();
-		auto format = rh.read<uint32>();
-		rh.skip(sizeof(FVector) * 2);
+#pragma pack(push, 1)
+	struct FileHeader {
+		char magic[8];
+		uint32 format;
+		FVector boundsMin;
+		FVector boundsMax;
+		uint16 boneCount;
+	};
+#pragma pack(pop)
 
-		TArray<uint16> boneLookup;
-		auto boneCount = rh.read<uint16>();
-		boneLookup.AddZeroed(boneCount);
-		for (uint16 i = 0; i < boneCount; ++i) {
-			boneLookup[i] = rh.read<uint16>();
-		}
+	// Everything about a ZMS that can be known without decoding geometry:
+	// the format mask, counts, bounds and the file offset of each section.
+	// Only the header, bone table and face count are read.
+	struct Probe {
+		// Leaves the read position undefined.
+		Probe(ReadHelper& rh) {
+			reset();
 
-		auto vertexCount = rh.read<uint16>();
-		vertexPositions.AddZeroed(vertexCount);
-		for (uint16 i = 0; i < vertexCount; ++i) {
-			vertexPositions[i] = rtuPosition(rh.read<FVector>()) * 100;
-		}
+			if (rh.length() < (int32)sizeof(FileHeader)) {
+				return;
+			}
 
-		if (format & ZMSF_NORMAL) {
-			vertexNormals.AddZeroed(vertexCount);
-			for (uint16 i = 0; i < vertexCount; ++i) {
-				vertexNormals[i] = rh.read<FVector>();
+			rh.seek(0);
+			FileHeader header = rh.read<FileHeader>();
+			int32 vertexCountOffset = sizeof(FileHeader) + header.boneCount * sizeof(uint16);
+			if (vertexCountOffset + (int32)sizeof(uint16) > rh.length()) {
+				return;
 			}
-		}
-		if (format & ZMSF_COLOR) {
-			vertexColors.AddZeroed(vertexCount);
-			for (uint16 i = 0; i < vertexCount; ++i) {
-				float alpha = rh.read<float>();
-				vertexColors[i] = FLinearColor(rh.read<float>(), rh.read<float>(), rh.read<float>(), alpha);
+
+			rh.seek(vertexCountOffset);
+			layout(header, rh.read<uint16>());
+			if (sectionOffsets[ZMSS_INDEX] > rh.length()) {
+				return;
 			}
+
+			rh.seek(sectionOffsets[ZMSS_INDEX] - sizeof(uint16));
+			faceCount = rh.read<uint16>();
+			valid = endOffset() <= rh.length();
 		}
-		if (format & ZMSF_BLENDINDEX && format & ZMSF_BLENDWEIGHT) {
-			boneWeights.AddZeroed(vertexCount);
-			for (uint16 i = 0; i < vertexCount; ++i) {
-				boneWeights[i] = rh.read<BoneWeights>();
-				boneWeights[i].boneIdx[0] = boneLookup[boneWeights[i].boneIdx[0]];
-				boneWeights[i].boneIdx[1] = boneLookup[boneWeights[i].boneIdx[1]];
-				boneWeights[i].boneIdx[2] = boneLookup[boneWeights[i].boneIdx[2]];
-				boneWeights[i].boneIdx[3] = boneLookup[boneWeights[i].boneIdx[3]];
-			}
+
+		bool has(ZmsSection section) const {
+			return sectionOffsets[section] != INDEX_NONE;
 		}
-		if (format & ZMSF_TANGENT) {
-			vertexTangents.AddZeroed(vertexCount);
-			for (uint16 i = 0; i < vertexCount; ++i) {
-				vertexTangents[i] = rtuPosition(rh.read<FVector>());
-			}
+
+		int32 indexCount() const {
+			return faceCount * 3;
 		}
-		if (format & ZMSF_UV1) {
-			vertexUvs[0].AddZeroed(vertexCount);
-			for (uint16 i = 0; i < vertexCount; ++i) {
-				vertexUvs[0][i] = rh.read<FVector2D>();
-			}
+
+		// One past the last byte the mesh data occupies.
+		int32 endOffset() const {
+			return sectionOffsets[ZMSS_INDEX] + indexCount() * sizeof(uint16);
 		}
-		if (format & ZMSF_UV2) {
-			vertexUvs[1].AddZeroed(vertexCount);
-			for (uint16 i = 0; i < vertexCount; ++i) {
-				vertexUvs[1][i] = rh.read<FVector2D>();
+
+		bool valid;
+		uint32 format;
+		FBox bounds;
+		uint16 boneCount;
+		uint16 vertexCount;
+		uint16 faceCount;
+		int32 boneLookupOffset;
+		int32 sectionOffsets[ZMSS_COUNT];
+
+	private:
+		void reset() {
+			valid = false;
+			format = 0;
+			bounds = FBox(0);
+			boneCount = 0;
+			vertexCount = 0;
+			faceCount = 0;
+			boneLookupOffset = sizeof(FileHeader);
+			for (int32 i = 0; i < ZMSS_COUNT; ++i) {
+				sectionOffsets[i] = INDEX_NONE;
 			}
 		}
-		if (format & ZMSF_UV3) {
-			vertexUvs[2].AddZeroed(vertexCount);
-			for (uint16 i = 0; i < vertexCount; ++i) {
-				vertexUvs[2][i] = rh.read<FVector2D>();
+
+		void layout(const FileHeader& header, uint16 _vertexCount) {
+			format = header.format;
+			boneCount = header.boneCount;
+			vertexCount = _vertexCount;
+
+			// Same conversion as the positions, so the box matches the decoded mesh.
+			FVector corners[2] = { header.boundsMin, header.boundsMax };
+			rtuPositions(corners, 2, 100);
+			bounds = FBox(corners, 2);
+
+			int32 offset = boneLookupOffset + boneCount * sizeof(uint16) + sizeof(uint16);
+			for (int32 i = ZMSS_POSITION; i < ZMSS_INDEX; ++i) {
+				ZmsSection section = (ZmsSection)i;
+				if (hasSection(format, section)) {
+					sectionOffsets[section] = offset;
+					offset += vertexCount * sectionElementSize(section);
+				}
 			}
+			sectionOffsets[ZMSS_INDEX] = offset + sizeof(uint16);
 		}
-		if (format & ZMSF_UV4) {
-			vertexUvs[3].AddZeroed(vertexCount);
-			for (uint16 i = 0; i < vertexCount; ++i) {
-				vertexUvs[3][i] = rh.read<FVector2D>();
-			}
+	};
+
+	static bool hasSection(uint32 format, ZmsSection section) {
+		switch (section) {
+		case ZMSS_POSITION: return true;
+		case ZMSS_NORMAL: return (format & ZMSF_NORMAL) != 0;
+		case ZMSS_COLOR: return (format & ZMSF_COLOR) != 0;
+		case ZMSS_BONEWEIGHT: return (format & ZMSF_BLENDINDEX) && (format & ZMSF_BLENDWEIGHT);
+		case ZMSS_TANGENT: return (format & ZMSF_TANGENT) != 0;
+		case ZMSS_UV1: return (format & ZMSF_UV1) != 0;
+		case ZMSS_UV2: return (format & ZMSF_UV2) != 0;
+		case ZMSS_UV3: return (format & ZMSF_UV3) != 0;
+		case ZMSS_UV4: return (format & ZMSF_UV4) != 0;
+		case ZMSS_INDEX: return true;
+		default: return false;
 		}
+	}
 
-		auto faceCount = rh.read<uint16>();
-		int indexCount = faceCount * 3;
-		indexes.AddZeroed(indexCount);
-		for (uint16 i = 0; i < indexCount; ++i) {
-			indexes[i] = rh.read<uint16>();
+	// Bytes one element of a section occupies in the file.
+	static int32 sectionElementSize(ZmsSection section) {
+		switch (section) {
+		case ZMSS_POSITION: return sizeof(FVector);
+		case ZMSS_NORMAL: return sizeof(FVector);
+		case ZMSS_COLOR: return sizeof(float) * 4;
+		case ZMSS_BONEWEIGHT: return sizeof(BoneWeights);
+		case ZMSS_TANGENT: return sizeof(FVector);
+		case ZMSS_UV1: return sizeof(FVector2D);
+		case ZMSS_UV2: return sizeof(FVector2D);
+		case ZMSS_UV3: return sizeof(FVector2D);
+		case ZMSS_UV4: return sizeof(FVector2D);
+		case ZMSS_INDEX: return sizeof(uint16);
+		default: return 0;
 		}
 	}
 
-	TArray<FVector> vertexPositions;
-	TArray<FLinearColor> vertexColors;
-	TArray<FVector> vertexNormals;
-	TArray<FVector> vertexTangents;
-	TArray<FVector2D> vertexUvs[4];
-	TArray<uint32> indexes;
-	TArray<BoneWeights> boneWeights;
+	// Decodes the streams in `attributes` that the file carries. Positions and
+	// indices are always decoded, so collision-only builds can pass 0; other
+	// streams are skipped by offset.
+	Zms(const TCHAR *Filename, uint32 attributes = ZMSF_ALL) : format(0), bounds(0) {
+		ReadHelper rh;
+		rh.open(Filename);
+		decode(rh, Filename, attributes);
+	}
+
+	// Decodes from a file the caller already has open, so it can look at the
+	// raw bytes too without reading the file again.
+	Zms(ReadHelper& rh, const TCHAR *Filename, uint32 attributes = ZMSF_ALL) : format(0), bounds(0) {
+		decode(rh, Filename, attributes);
+	}
+
+	uint32 format;
+	FBox bounds;
+	Span<FVector> vertexPositions;
+	Span<FLinearColor> vertexColors;
+	Span<FVector> vertexNormals;
+	Span<FVector> vertexTangents;
+	Span<FVector2D> vertexUvs[4];
+	Span<uint16> indexes;
+	Span<BoneWeights> boneWeights;
 
 private:
-	ReadHelper rh;
+	void decode(ReadHelper& rh, const TCHAR *Filename, uint32 attributes) {
+		Probe probe(rh);
+		if (!probe.valid) {
+			UE_LOG(RosePlugin, Warning, TEXT("Skipped truncated or unreadable ZMS %s"), Filename);
+			return;
+		}
+
+		format = probe.format;
+		bounds = probe.bounds;
+		int32 vertexCount = probe.vertexCount;
+		int32 indexCount = probe.indexCount();
+
+		TArray<uint16> boneLookup;
+		if (hasSection(probe.format & attributes, ZMSS_BONEWEIGHT)) {
+			rh.seek(probe.boneLookupOffset);
+			rh.readArray(boneLookup, probe.boneCount);
+		}
+
+		// Offsets into the arena for each stream the format carries. ZMS
+		// counts are 16-bit, so indices always fit and are kept as uint16.
+		int32 arenaSize = 0;
+		int32 positionOffset = reserve<FVector>(arenaSize, vertexCount);
+		uint32 wanted = probe.format & attributes;
+		int32 normalOffset = hasSection(wanted, ZMSS_NORMAL) ? reserve<FVector>(arenaSize, vertexCount) : INDEX_NONE;
+		int32 colorOffset = hasSection(wanted, ZMSS_COLOR) ? reserve<FLinearColor>(arenaSize, vertexCount) : INDEX_NONE;
+		int32 boneWeightOffset = hasSection(wanted, ZMSS_BONEWEIGHT) ? reserve<BoneWeights>(arenaSize, vertexCount) : INDEX_NONE;
+		int32 tangentOffset = hasSection(wanted, ZMSS_TANGENT) ? reserve<FVector>(arenaSize, vertexCount) : INDEX_NONE;
+		int32 uvOffset[4];
+		for (int32 k = 0; k < 4; ++k) {
+			uvOffset[k] = hasSection(wanted, (ZmsSection)(ZMSS_UV1 + k)) ? reserve<FVector2D>(arenaSize, vertexCount) : INDEX_NONE;
+		}
+		int32 indexOffset = reserve<uint16>(arenaSize, indexCount);
+
+		// Every stream is written in full below, so there is no need to zero it first.
+		arena.Empty(arenaSize);
+		arena.AddUninitialized(arenaSize);
+
+		rh.seek(probe.sectionOffsets[ZMSS_POSITION]);
+		vertexPositions = carve<FVector>(positionOffset, vertexCount);
+		rh.readArray(vertexPositions.GetData(), vertexCount);
+		rtuPositions(vertexPositions.GetData(), vertexCount, 100);
+
+		if (normalOffset != INDEX_NONE) {
+			rh.seek(probe.sectionOffsets[ZMSS_NORMAL]);
+			vertexNormals = carve<FVector>(normalOffset, vertexCount);
+			rh.readArray(vertexNormals.GetData(), vertexCount);
+		}
+		if (colorOffset != INDEX_NONE) {
+			struct FileColor { float a, r, g, b; };
+			rh.seek(probe.sectionOffsets[ZMSS_COLOR]);
+			vertexColors = carve<FLinearColor>(colorOffset, vertexCount);
+			rh.readArray<FileColor>(vertexColors.GetData(), vertexCount, [](const FileColor& c) {
+				return FLinearColor(c.r, c.g, c.b, c.a);
+			});
+		}
+		if (boneWeightOffset != INDEX_NONE) {
+			rh.seek(probe.sectionOffsets[ZMSS_BONEWEIGHT]);
+			boneWeights = carve<BoneWeights>(boneWeightOffset, vertexCount);
+			rh.readArray<BoneWeights>(boneWeights.GetData(), vertexCount, [&boneLookup](BoneWeights w) {
+				w.boneIdx[0] = boneLookup[w.boneIdx[0]];
+				w.boneIdx[1] = boneLookup[w.boneIdx[1]];
+				w.boneIdx[2] = boneLookup[w.boneIdx[2]];
+				w.boneIdx[3] = boneLookup[w.boneIdx[3]];
+				return w;
+			});
+		}
+		if (tangentOffset != INDEX_NONE) {
+			rh.seek(probe.sectionOffsets[ZMSS_TANGENT]);
+			vertexTangents = carve<FVector>(tangentOffset, vertexCount);
+			rh.readArray(vertexTangents.GetData(), vertexCount);
+			rtuPositions(vertexTangents.GetData(), vertexCount);
+		}
+		for (int32 k = 0; k < 4; ++k) {
+			if (uvOffset[k] != INDEX_NONE) {
+				rh.seek(probe.sectionOffsets[ZMSS_UV1 + k]);
+				vertexUvs[k] = carve<FVector2D>(uvOffset[k], vertexCount);
+				rh.readArray(vertexUvs[k].GetData(), vertexCount);
+			}
+		}
+
+		rh.seek(probe.sectionOffsets[ZMSS_INDEX]);
+		indexes = carve<uint16>(indexOffset, indexCount);
+		rh.readArray(indexes.GetData(), indexCount);
+	}
+
+	template<typename T> static int32 reserve(int32& size, int32 count) {
+		int32 offset = Align(size, 16);
+		size = offset + sizeof(T) * count;
+		return offset;
+	}
+
+	template<typename T> Span<T> carve(int32 offset, int32 count) {
+		return Span<T>((T*)(arena.GetData() + offset), count);
+	}
+
+	// Backing store for every stream above.
+	TArray<uint8> arena;
 };
@@ -2,7 +2,7 @@
 
 #include "Common.h"
 
-class Zsc {
+class Zsc : public FNoncopyable {
 public:
 	struct CollisionType {
 		enum Type {
@@ -37,7 +37,7 @@ public:
 	};
 
 	struct Texture {
-		FString filePath;
+		FName filePath;
 		bool useSkinShader;
 		bool alphaEnabled;
 		bool twoSided;
@@ -84,18 +84,53 @@ public:
 		TArray<Effect> effects;
 	};
 
-	Zsc(const TCHAR *Filename) {
-		FFileHelper::LoadFileToArray(rh.data, Filename);
+	// Models are decoded on first access. Only a table of file offsets and
+	// part counts is built up front, which is all an import needs to pick
+	// the models it wants out of a large list. Decoding seeks the shared
+	// file reader, so a lazy Zsc must not be used from more than one thread;
+	// an eager one is fully decoded and safe to read from anywhere.
+	class ModelTable {
+	public:
+		int32 Num() const {
+			return offsets.Num();
+		}
+
+		uint16 partCount(int32 i) const {
+			return partCounts[i];
+		}
+
+		const Model& operator[](int32 i) const {
+			if (!decoded[i]) {
+				owner->decodeModel(offsets[i], cache[i]);
+				decoded[i] = true;
+			}
+			return cache[i];
+		}
+
+	private:
+		friend class Zsc;
+
+		const Zsc *owner;
+		TArray<int32> offsets;
+		TArray<uint16> partCounts;
+		mutable TArray<Model> cache;
+		mutable TArray<bool> decoded;
+	};
+
+	Zsc(const TCHAR *Filename, bool lazyModels = false) {
+		rh.open(Filename);
 
 		auto meshCount = rh.read<uint16>();
+		meshes.Empty(meshCount);
 		for (uint16 i = 0; i < meshCount; ++i) {
-			meshes.Add(rh.readStr());
+			meshes.Add(internPath(rh.readStr()));
 		}
 
 		auto textureCount = rh.read<uint16>();
+		textures.Empty(textureCount);
 		for (uint16 i = 0; i < textureCount; ++i) {
 			Texture t;
-			t.filePath = rh.readStr();
+			t.filePath = internPath(rh.readStr());
 			t.useSkinShader = rh.read<uint16>() != 0;
 			t.alphaEnabled = rh.read<uint16>() != 0;
 			t.twoSided = rh.read<uint16>() != 0;
@@ -112,108 +147,152 @@ public:
 		}
 
 		auto effectCount = rh.read<uint16>();
+		effects.Empty(effectCount);
 		for (uint16 i = 0; i < effectCount; ++i) {
-			effects.Add(rh.readStr());
+			effects.Add(internPath(rh.readStr()));
 		}
 
-		char AnimPathBuffer[512];
 		auto modelCount = rh.read<uint16>();
+		models.owner = this;
+		models.offsets.Empty(modelCount);
+		models.partCounts.Empty(modelCount);
 		for (uint16 i = 0; i < modelCount; ++i) {
 			rh.skip(sizeof(int32) * 3);
+			models.offsets.Add(rh.tell());
+			models.partCounts.Add(skipModel());
+		}
+		models.cache.AddDefaulted(modelCount);
+		models.decoded.AddZeroed(modelCount);
 
-			Model m;
-
-			auto partCount = rh.read<uint16>();
-			if (partCount > 0) {
-				for (uint16 j = 0; j < partCount; ++j) {
-					Part p;
-					p.meshIdx = rh.read<uint16>();
-					p.texIdx = rh.read<uint16>();
-
-					p.position = FVector::ZeroVector;
-					p.rotation = FQuat::Identity;
-					p.scale = FVector(1, 1, 1);
-					p.axisRotation = FQuat::Identity;
-					p.parentIdx = 0xFF;
-					p.collisionType = 0;
-					p.boneIdx = 0xFFFF;
-					p.dummyIdx = 0xFFFF;
-
-					uint8 propType = 0;
-					while ((propType = rh.read<uint8>()) != 0) {
-						auto propSize = rh.read<uint8>();
-
-						if (propType == PropertyType::Position) {
-							p.position = rtuPosition(rh.read<FVector>());
-						} else if (propType == PropertyType::Rotation) {
-							p.rotation = rtuRotation(rh.readBadQuat());
-						} else if (propType == PropertyType::Scale) {
-							p.scale = rtuScale(rh.read<FVector>());
-						} else if (propType == PropertyType::AxisRotation) {
-							p.axisRotation = rtuRotation(rh.readBadQuat());
-						} else if (propType == PropertyType::Parent) {
-							p.parentIdx = rh.read<uint16>();
-						} else if (propType == PropertyType::Collision) {
-							p.collisionType = rh.read<uint16>();
-						} else if (propType == PropertyType::ConstantAnimation) {
-							memcpy(AnimPathBuffer, rh.read(propSize), propSize);
-							AnimPathBuffer[propSize] = 0;
-							p.animPath = AnimPathBuffer;
-						} else if (propType == PropertyType::BoneIndex) {
-							p.boneIdx = rh.read<uint16>();
-						} else if (propType == PropertyType::DummyIndex) {
-							p.dummyIdx = rh.read<uint16>();
-						} else {
-							rh.skip(propSize);
-						}
-					}
+		if (!lazyModels) {
+			for (int32 i = 0; i < modelCount; ++i) {
+				models[i];
+			}
+			rh.close();
+		}
+	}
 
-					m.parts.Add(p);
-				}
+	TArray<FName> meshes;
+	TArray<Texture> textures;
+	TArray<FName> effects;
+	ModelTable models;
+
+private:
+	// Steps over a model's parts and effects without decoding them and
+	// returns its part count.
+	uint16 skipModel() {
+		auto partCount = rh.read<uint16>();
+		if (partCount > 0) {
+			for (uint16 j = 0; j < partCount; ++j) {
+				rh.skip(sizeof(uint16) * 2);
+				skipProperties();
+			}
+
+			auto effectCount = rh.read<uint16>();
+			for (uint16 j = 0; j < effectCount; ++j) {
+				rh.skip(sizeof(uint16) * 2);
+				skipProperties();
+			}
+
+			rh.skip(sizeof(float) * 3 * 2);
+		}
+		return partCount;
+	}
+
+	void skipProperties() {
+		while (rh.read<uint8>() != 0) {
+			rh.skip(rh.read<uint8>());
+		}
+	}
+
+	void decodeModel(int32 offset, Model& m) const {
+		char AnimPathBuffer[512];
+		rh.seek(offset);
+
+		auto partCount = rh.read<uint16>();
+		if (partCount > 0) {
+			for (uint16 j = 0; j < partCount; ++j) {
+				Part p;
+				p.meshIdx = rh.read<uint16>();
+				p.texIdx = rh.read<uint16>();
+
+				p.position = FVector::ZeroVector;
+				p.rotation = FQuat::Identity;
+				p.scale = FVector(1, 1, 1);
+				p.axisRotation = FQuat::Identity;
+				p.parentIdx = 0xFF;
+				p.collisionType = 0;
+				p.boneIdx = 0xFFFF;
+				p.dummyIdx = 0xFFFF;
 
-				auto effectCount = rh.read<uint16>();
-				for (uint16 j = 0; j < effectCount; ++j) {
-					Effect e;
-					e.effectType = rh.read<uint16>();
-					e.effectIdx = rh.read<uint16>();
-
-					e.position = FVector::ZeroVector;
-					e.rotation = FQuat::Identity;
-					e.scale = FVector(1, 1, 1);
-					e.parentIdx = 0;
-
-					uint8 propType = 0;
-					while ((propType = rh.read<uint8>()) != 0) {
-						auto propSize = rh.read<uint8>();
-
-						if (propType == PropertyType::Position) {
-							e.position = rtuPosition(rh.read<FVector>());
-						} else if (propType == PropertyType::Rotation) {
-							e.rotation = rtuRotation(rh.readBadQuat());
-						} else if (propType == PropertyType::Scale) {
-							e.scale = rtuScale(rh.read<FVector>());
-						} else if (propType == PropertyType::Parent) {
-							e.parentIdx = rh.read<uint16>();
-						} else {
-							rh.skip(propSize);
-						}
+				uint8 propType = 0;
+				while ((propType = rh.read<uint8>()) != 0) {
+					auto propSize = rh.read<uint8>();
+
+					if (propType == PropertyType::Position) {
+						p.position = rtuPosition(rh.read<FVector>());
+					} else if (propType == PropertyType::Rotation) {
+						p.rotation = rtuRotation(rh.readBadQuat());
+					} else if (propType == PropertyType::Scale) {
+						p.scale = rtuScale(rh.read<FVector>());
+					} else if (propType == PropertyType::AxisRotation) {
+						p.axisRotation = rtuRotation(rh.readBadQuat());
+					} else if (propType == PropertyType::Parent) {
+						p.parentIdx = rh.read<uint16>();
+					} else if (propType == PropertyType::Collision) {
+						p.collisionType = rh.read<uint16>();
+					} else if (propType == PropertyType::ConstantAnimation) {
+						memcpy(AnimPathBuffer, rh.read(propSize), propSize);
+						AnimPathBuffer[propSize] = 0;
+						p.animPath = AnimPathBuffer;
+					} else if (propType == PropertyType::BoneIndex) {
+						p.boneIdx = rh.read<uint16>();
+					} else if (propType == PropertyType::DummyIndex) {
+						p.dummyIdx = rh.read<uint16>();
+					} else {
+						rh.skip(propSize);
 					}
+				}
+
+				m.parts.Add(p);
+			}
+
+			auto effectCount = rh.read<uint16>();
+			for (uint16 j = 0; j < effectCount; ++j) {
+				Effect e;
+				e.effectType = rh.read<uint16>();
+				e.effectIdx = rh.read<uint16>();
+
+				e.position = FVector::ZeroVector;
+				e.rotation = FQuat::Identity;
+				e.scale = FVector(1, 1, 1);
+				e.parentIdx = 0;
 
-					m.effects.Add(e);
+				uint8 propType = 0;
+				while ((propType = rh.read<uint8>()) != 0) {
+					auto propSize = rh.read<uint8>();
+
+					if (propType == PropertyType::Position) {
+						e.position = rtuPosition(rh.read<FVector>());
+					} else if (propType == PropertyType::Rotation) {
+						e.rotation = rtuRotation(rh.readBadQuat());
+					} else if (propType == PropertyType::Scale) {
+						e.scale = rtuScale(rh.read<FVector>());
+					} else if (propType == PropertyType::Parent) {
+						e.parentIdx = rh.read<uint16>();
+					} else {
+						rh.skip(propSize);
+					}
 				}
 
-				rh.skip(sizeof(float) * 3 * 2);
+				m.effects.Add(e);
 			}
 
-			models.Add(m);
+			rh.skip(sizeof(float) * 3 * 2);
 		}
 	}
 
-	TArray<FString> meshes;
-	TArray<Texture> textures;
-	TArray<FString> effects;
-	TArray<Model> models;
-
-private:
-	ReadHelper rh;
-};
\ No newline at end of file
+	// Only kept open in lazy mode, where models still decode from it. Its
+	// position is what makes lazy access single-threaded.
+	mutable ReadHelper rh;
+};